@@ -0,0 +1,268 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "AACE/Engine/Core/EngineMacros.h"
+#include "AACE/Engine/LocalSkillService/AsyncLogger.h"
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+// String to identify log entries originating from this file.
+static const std::string TAG("aace.localSkillService.AsyncLogger");
+
+// how often the logger thread drains the thread buffers while records keep arriving; it sleeps once they are empty
+static const std::chrono::milliseconds DRAIN_INTERVAL( 20 );
+
+const size_t AsyncLogger::MAX_ARGUMENTS;
+const size_t AsyncLogger::TEXT_CAPACITY;
+const size_t AsyncLogger::RING_CAPACITY;
+
+std::atomic<AsyncLogger::Level> AsyncLogger::s_level( AsyncLogger::Level::WARN );
+
+static void writeToEngineLogger( AsyncLogger::Level level, std::chrono::system_clock::time_point time, const char* tag, const std::string& message ) {
+    // the engine logger stamps entries when they are written, so the original time travels along
+    auto loggedAt = std::chrono::duration_cast<std::chrono::microseconds>( time.time_since_epoch() ).count();
+    switch( level ) {
+        case AsyncLogger::Level::VERBOSE:
+            AACE_VERBOSE(LX(tag).d("loggedAt", loggedAt).m(message));
+            break;
+        case AsyncLogger::Level::INFO:
+            AACE_INFO(LX(tag).d("loggedAt", loggedAt).m(message));
+            break;
+        case AsyncLogger::Level::WARN:
+            AACE_WARN(LX(tag).d("loggedAt", loggedAt).m(message));
+            break;
+        default:
+            AACE_ERROR(LX(tag).d("loggedAt", loggedAt).m(message));
+            break;
+    }
+}
+
+AsyncLogger& AsyncLogger::getInstance() {
+    static AsyncLogger instance;
+    return instance;
+}
+
+AsyncLogger::AsyncLogger() : m_sink( writeToEngineLogger ), m_running( true ) {
+    m_thread = std::thread( &AsyncLogger::run, this );
+}
+
+AsyncLogger::~AsyncLogger() {
+    {
+        std::lock_guard<std::mutex> guard( m_mutex );
+        m_running = false;
+    }
+    m_cv.notify_all();
+    if ( m_thread.joinable() ) {
+        m_thread.join();
+    }
+    drain();
+}
+
+void AsyncLogger::setLevel( Level level ) {
+    s_level.store( level, std::memory_order_relaxed );
+}
+
+void AsyncLogger::setSink( Sink sink ) {
+    std::lock_guard<std::mutex> guard( m_mutex );
+    m_sink = sink ? sink : Sink( writeToEngineLogger );
+}
+
+void AsyncLogger::flush() {
+    drain();
+}
+
+AsyncLogger::ThreadBufferHolder::~ThreadBufferHolder() {
+    if ( buffer ) {
+        buffer->retired.store( true, std::memory_order_release );
+    }
+}
+
+AsyncLogger::ThreadBuffer& AsyncLogger::getThreadBuffer() {
+    static thread_local ThreadBufferHolder holder;
+    if ( !holder.buffer ) {
+        holder.buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> guard( m_mutex );
+        m_buffers.push_back( holder.buffer );
+    }
+    return *holder.buffer;
+}
+
+AsyncLogger::Record* AsyncLogger::beginRecord( ThreadBuffer& buffer ) {
+    auto tail = buffer.tail.load( std::memory_order_relaxed );
+    if ( tail - buffer.head.load( std::memory_order_acquire ) >= RING_CAPACITY ) {
+        buffer.dropped.fetch_add( 1, std::memory_order_relaxed );
+        return nullptr;
+    }
+    auto& record = buffer.records[ tail % RING_CAPACITY ];
+    record.time = std::chrono::system_clock::now();
+    record.count = 0;
+    record.textSize = 0;
+    return &record;
+}
+
+void AsyncLogger::run() {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    while ( m_running ) {
+        lock.unlock();
+        bool written = drain();
+        lock.lock();
+        if ( !m_running ) {
+            break;
+        }
+        if ( written ) {
+            // records are arriving; collect more of them before the next drain
+            m_cv.wait_for( lock, DRAIN_INTERVAL );
+            continue;
+        }
+        m_idle.store( true );
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        if ( hasPendingRecords() ) {
+            m_idle.store( false );
+            continue;
+        }
+        m_cv.wait( lock, [this]() { return !m_idle.load() || !m_running; } );
+        m_idle.store( false );
+    }
+}
+
+bool AsyncLogger::hasPendingRecords() const {
+    for ( auto& buffer : m_buffers ) {
+        if ( buffer->head.load() != buffer->tail.load() || buffer->dropped.load() > 0 ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AsyncLogger::wake() {
+    if ( m_idle.exchange( false ) ) {
+        // the logger thread checks m_idle and blocks under the mutex, so passing through it keeps the notify from being lost
+        {
+            std::lock_guard<std::mutex> guard( m_mutex );
+        }
+        m_cv.notify_one();
+    }
+}
+
+bool AsyncLogger::drain() {
+    std::lock_guard<std::mutex> drainGuard( m_drainMutex );
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    Sink sink;
+    {
+        std::lock_guard<std::mutex> guard( m_mutex );
+        // buffers of exited threads are released once everything they logged has been written
+        m_buffers.erase( std::remove_if( m_buffers.begin(), m_buffers.end(), []( const std::shared_ptr<ThreadBuffer>& buffer ) {
+            return buffer->retired.load( std::memory_order_acquire ) && buffer->head.load() == buffer->tail.load();
+        }), m_buffers.end() );
+        buffers = m_buffers;
+        sink = m_sink;
+    }
+    bool written = false;
+    for ( auto& buffer : buffers ) {
+        auto head = buffer->head.load( std::memory_order_relaxed );
+        auto tail = buffer->tail.load( std::memory_order_acquire );
+        for ( ; head != tail; head++ ) {
+            auto& record = buffer->records[ head % RING_CAPACITY ];
+            sink( record.level, record.time, record.tag, record.format() );
+            buffer->head.store( head + 1, std::memory_order_release );
+            written = true;
+        }
+        auto dropped = buffer->dropped.exchange( 0, std::memory_order_relaxed );
+        if ( dropped > 0 ) {
+            sink( Level::WARN, std::chrono::system_clock::now(), TAG.c_str(), "recordsDropped:count=" + std::to_string( dropped ) );
+        }
+    }
+    return written;
+}
+
+void AsyncLogger::Record::add( const char* key, Type type, Value value ) {
+    if ( count == MAX_ARGUMENTS ) {
+        return;
+    }
+    keys[count] = key;
+    types[count] = type;
+    values[count] = value;
+    count++;
+}
+
+void AsyncLogger::Record::add( const char* key, bool value ) {
+    Value v;
+    v.u = value ? 1 : 0;
+    add( key, Type::BOOL, v );
+}
+
+void AsyncLogger::Record::add( const char* key, double value ) {
+    Value v;
+    v.d = value;
+    add( key, Type::DOUBLE, v );
+}
+
+void AsyncLogger::Record::add( const char* key, const char* value ) {
+    addString( key, value, value != nullptr ? std::strlen( value ) : 0 );
+}
+
+void AsyncLogger::Record::add( const char* key, const std::string& value ) {
+    addString( key, value.data(), value.size() );
+}
+
+void AsyncLogger::Record::addString( const char* key, const char* data, size_t length ) {
+    // long values are cut to whatever room is left in the record
+    length = std::min( length, TEXT_CAPACITY - textSize );
+    Value v;
+    v.s.offset = static_cast<uint32_t>( textSize );
+    v.s.length = static_cast<uint32_t>( length );
+    if ( length > 0 ) {
+        std::memcpy( text + textSize, data, length );
+        textSize += length;
+    }
+    add( key, Type::STRING, v );
+}
+
+std::string AsyncLogger::Record::format() const {
+    std::string message( event != nullptr ? event : "" );
+    for ( size_t index = 0; index < count; index++ ) {
+        message += index == 0 ? ':' : ',';
+        message += keys[index];
+        message += '=';
+        switch( types[index] ) {
+            case Type::INT:
+                message += std::to_string( values[index].i );
+                break;
+            case Type::UINT:
+                message += std::to_string( values[index].u );
+                break;
+            case Type::DOUBLE:
+                message += std::to_string( values[index].d );
+                break;
+            case Type::BOOL:
+                message += values[index].u ? "true" : "false";
+                break;
+            case Type::STRING:
+                message.append( text + values[index].s.offset, values[index].s.length );
+                break;
+        }
+    }
+    return message;
+}
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
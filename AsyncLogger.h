@@ -0,0 +1,214 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOCAL_SKILL_SERVICE_ASYNC_LOGGER_H
+#define AACE_ENGINE_LOCAL_SKILL_SERVICE_ASYNC_LOGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+/**
+ * Logger for the request and delivery hot paths. A log call copies its arguments as a binary record
+ * into a lock-free ring buffer owned by the calling thread; a background thread formats the records
+ * as "event:key=value,..." and hands them to the sink. When a ring is full the record is dropped and
+ * counted rather than blocking the caller.
+ *
+ * Use the LSS_LOG macros, which check the level before any argument is evaluated. Tags, events and keys
+ * are stored by pointer and must be string literals or otherwise outlive the logger. String values are
+ * copied and truncated to fit the record.
+ */
+class AsyncLogger {
+public:
+    enum class Level { VERBOSE, INFO, WARN, ERROR, NONE };
+
+    // receives each record with the time it was logged
+    using Sink = std::function<void( Level level, std::chrono::system_clock::time_point time, const char* tag, const std::string& message )>;
+
+    static AsyncLogger& getInstance();
+
+    static bool isEnabled( Level level ) {
+        return level >= s_level.load( std::memory_order_relaxed );
+    }
+
+    static void setLevel( Level level );
+
+    /**
+     * Replaces the sink the background thread writes formatted records to. The default sink forwards
+     * to the engine logger.
+     */
+    void setSink( Sink sink );
+
+    template <typename... Args>
+    void log( Level level, const char* tag, const char* event, const Args&... args );
+
+    /**
+     * Formats and writes every record logged so far.
+     */
+    void flush();
+
+    ~AsyncLogger();
+
+private:
+    AsyncLogger();
+    AsyncLogger( const AsyncLogger& ) = delete;
+    AsyncLogger& operator=( const AsyncLogger& ) = delete;
+
+    static const size_t MAX_ARGUMENTS = 6;
+    static const size_t TEXT_CAPACITY = 128;
+    static const size_t RING_CAPACITY = 256;
+
+    enum class Type : uint8_t { INT, UINT, DOUBLE, BOOL, STRING };
+
+    struct Record {
+        std::chrono::system_clock::time_point time;
+        Level level;
+        const char* tag;
+        const char* event;
+        size_t count;
+        size_t textSize;
+        const char* keys[ MAX_ARGUMENTS ];
+        Type types[ MAX_ARGUMENTS ];
+        union Value {
+            int64_t i;
+            uint64_t u;
+            double d;
+            // offset and length of the copied bytes in text
+            struct { uint32_t offset; uint32_t length; } s;
+        } values[ MAX_ARGUMENTS ];
+        char text[ TEXT_CAPACITY ];
+
+        void add( const char* key, Type type, Value value );
+        void add( const char* key, bool value );
+        void add( const char* key, double value );
+        void add( const char* key, const char* value );
+        void add( const char* key, const std::string& value );
+        void addString( const char* key, const char* data, size_t length );
+
+        template <typename T>
+        typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type add( const char* key, T value ) {
+            Value v;
+            v.i = value;
+            add( key, Type::INT, v );
+        }
+
+        template <typename T>
+        typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type add( const char* key, T value ) {
+            Value v;
+            v.u = value;
+            add( key, Type::UINT, v );
+        }
+
+        std::string format() const;
+    };
+
+    // single producer (the owning thread), single consumer (the logger thread)
+    struct ThreadBuffer {
+        Record records[ RING_CAPACITY ];
+        std::atomic<uint64_t> head{ 0 };
+        std::atomic<uint64_t> tail{ 0 };
+        std::atomic<uint64_t> dropped{ 0 };
+        // the owning thread has exited; the buffer is released once drained
+        std::atomic<bool> retired{ false };
+    };
+
+    struct ThreadBufferHolder {
+        std::shared_ptr<ThreadBuffer> buffer;
+        ~ThreadBufferHolder();
+    };
+
+    static void pack( Record& ) {}
+
+    template <typename T, typename... Rest>
+    static void pack( Record& record, const char* key, const T& value, const Rest&... rest ) {
+        record.add( key, value );
+        pack( record, rest... );
+    }
+
+    Record* beginRecord( ThreadBuffer& buffer );
+    ThreadBuffer& getThreadBuffer();
+    void run();
+    bool drain();
+    // called with m_mutex held
+    bool hasPendingRecords() const;
+    void wake();
+
+    static std::atomic<Level> s_level;
+
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+    Sink m_sink;
+    // guards the buffer list and the sink
+    std::mutex m_mutex;
+    // serializes draining between the logger thread and flush()
+    std::mutex m_drainMutex;
+    std::condition_variable m_cv;
+    bool m_running;
+    // set while the logger thread sleeps because every ring is empty
+    std::atomic<bool> m_idle{ false };
+    std::thread m_thread;
+};
+
+template <typename... Args>
+void AsyncLogger::log( Level level, const char* tag, const char* event, const Args&... args ) {
+    static_assert( sizeof...( args ) % 2 == 0, "log arguments are key/value pairs" );
+    static_assert( sizeof...( args ) / 2 <= MAX_ARGUMENTS, "too many log arguments" );
+    auto& buffer = getThreadBuffer();
+    auto record = beginRecord( buffer );
+    if ( record == nullptr ) {
+        return;
+    }
+    record->level = level;
+    record->tag = tag;
+    record->event = event;
+    pack( *record, args... );
+    buffer.tail.store( buffer.tail.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+    // pairs with the fence in run(): either the logger thread sees this record or this call sees it idle
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if ( m_idle.load( std::memory_order_relaxed ) ) {
+        wake();
+    }
+}
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
+
+#define LSS_LOG( level, ... ) \
+    do { \
+        if ( aace::engine::localSkillService::AsyncLogger::isEnabled( level ) ) { \
+            aace::engine::localSkillService::AsyncLogger::getInstance().log( level, __VA_ARGS__ ); \
+        } \
+    } while( 0 )
+
+#define LSS_VERBOSE( ... ) LSS_LOG( aace::engine::localSkillService::AsyncLogger::Level::VERBOSE, __VA_ARGS__ )
+#define LSS_INFO( ... ) LSS_LOG( aace::engine::localSkillService::AsyncLogger::Level::INFO, __VA_ARGS__ )
+#define LSS_WARN( ... ) LSS_LOG( aace::engine::localSkillService::AsyncLogger::Level::WARN, __VA_ARGS__ )
+#define LSS_ERROR( ... ) LSS_LOG( aace::engine::localSkillService::AsyncLogger::Level::ERROR, __VA_ARGS__ )
+
+#endif // AACE_ENGINE_LOCAL_SKILL_SERVICE_ASYNC_LOGGER_H
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOCAL_SKILL_SERVICE_BOUNDED_QUEUE_H
+#define AACE_ENGINE_LOCAL_SKILL_SERVICE_BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+/**
+ * Bounded multi-producer/multi-consumer queue built on a ring of sequenced cells. Values are moved
+ * in and out of preallocated cells, so push and pop never allocate. The capacity is rounded up to a power of two.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue( size_t capacity ) : m_enqueuePos( 0 ), m_dequeuePos( 0 ) {
+        size_t size = 2;
+        while ( size < capacity ) {
+            size <<= 1;
+        }
+        m_cells.reset( new Cell[ size ] );
+        m_mask = size - 1;
+        for ( size_t i = 0; i < size; i++ ) {
+            m_cells[ i ].sequence.store( i, std::memory_order_relaxed );
+        }
+    }
+
+    ~BoundedQueue() {
+        T value;
+        while ( pop( value ) ) {
+        }
+    }
+
+    /**
+     * Moves the value into the queue. Returns false, leaving the value untouched, if the queue is full.
+     */
+    bool push( T& value ) {
+        Cell* cell;
+        size_t pos = m_enqueuePos.load( std::memory_order_relaxed );
+        for ( ;; ) {
+            cell = &m_cells[ pos & m_mask ];
+            size_t sequence = cell->sequence.load( std::memory_order_acquire );
+            intptr_t diff = static_cast<intptr_t>( sequence ) - static_cast<intptr_t>( pos );
+            if ( diff == 0 ) {
+                if ( m_enqueuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) ) {
+                    break;
+                }
+            }
+            else if ( diff < 0 ) {
+                return false;
+            }
+            else {
+                pos = m_enqueuePos.load( std::memory_order_relaxed );
+            }
+        }
+        new ( &cell->storage ) T( std::move( value ) );
+        cell->sequence.store( pos + 1, std::memory_order_release );
+        return true;
+    }
+
+    bool pop( T& value ) {
+        Cell* cell;
+        size_t pos = m_dequeuePos.load( std::memory_order_relaxed );
+        for ( ;; ) {
+            cell = &m_cells[ pos & m_mask ];
+            size_t sequence = cell->sequence.load( std::memory_order_acquire );
+            intptr_t diff = static_cast<intptr_t>( sequence ) - static_cast<intptr_t>( pos + 1 );
+            if ( diff == 0 ) {
+                if ( m_dequeuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) ) {
+                    break;
+                }
+            }
+            else if ( diff < 0 ) {
+                return false;
+            }
+            else {
+                pos = m_dequeuePos.load( std::memory_order_relaxed );
+            }
+        }
+        T* stored = reinterpret_cast<T*>( &cell->storage );
+        value = std::move( *stored );
+        stored->~T();
+        cell->sequence.store( pos + m_mask + 1, std::memory_order_release );
+        return true;
+    }
+
+    // approximate number of queued values
+    size_t size() const {
+        size_t enqueued = m_enqueuePos.load( std::memory_order_relaxed );
+        size_t dequeued = m_dequeuePos.load( std::memory_order_relaxed );
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+private:
+    BoundedQueue( const BoundedQueue& ) = delete;
+    BoundedQueue& operator=( const BoundedQueue& ) = delete;
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof( T ), alignof( T )>::type storage;
+    };
+
+    static const size_t CACHE_LINE_SIZE = 64;
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask;
+    // keep producers and consumers off each other's cache line
+    char m_padding0[ CACHE_LINE_SIZE ];
+    std::atomic<size_t> m_enqueuePos;
+    char m_padding1[ CACHE_LINE_SIZE ];
+    std::atomic<size_t> m_dequeuePos;
+};
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
+
+#endif // AACE_ENGINE_LOCAL_SKILL_SERVICE_BOUNDED_QUEUE_H
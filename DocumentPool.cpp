@@ -0,0 +1,70 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "AACE/Engine/LocalSkillService/DocumentPool.h"
+#include "AACE/Engine/LocalSkillService/RecyclingPool.h"
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+// arenas kept by each thread for reuse; arenas are returned to the thread that created them
+static const size_t THREAD_CACHE_SIZE = 32;
+
+// scratch buffers larger than this are released instead of being kept with the arena
+static const size_t MAX_RETAINED_BUFFER = 64 * 1024;
+
+const size_t DocumentArena::BUFFER_SIZE;
+
+DocumentArena::DocumentArena() :
+    m_allocator( &m_chunk, BUFFER_SIZE ),
+    m_document( &m_allocator ) {
+}
+
+void DocumentArena::reset() {
+    m_document.SetNull();
+    m_allocator.Clear();
+    if ( m_buffer.capacity() > MAX_RETAINED_BUFFER ) {
+        std::string().swap( m_buffer );
+    }
+    else {
+        m_buffer.clear();
+    }
+}
+
+namespace {
+
+using ArenaPool = RecyclingPool<DocumentArena, THREAD_CACHE_SIZE>;
+
+void releaseArena( DocumentArena* arena ) {
+    arena->reset();
+    ArenaPool::release( arena );
+}
+
+} // namespace
+
+std::shared_ptr<DocumentArena> DocumentPool::acquireArena() {
+    // the control block comes from a pool as well, so handing out an arena takes no lock and does not allocate
+    return std::shared_ptr<DocumentArena>( ArenaPool::acquire(), releaseArena, PoolAllocator<DocumentArena>() );
+}
+
+std::shared_ptr<rapidjson::Document> DocumentPool::acquire() {
+    auto arena = acquireArena();
+    return std::shared_ptr<rapidjson::Document>( arena, &arena->getDocument() );
+}
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOCAL_SKILL_SERVICE_DOCUMENT_POOL_H
+#define AACE_ENGINE_LOCAL_SKILL_SERVICE_DOCUMENT_POOL_H
+
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include <rapidjson/document.h>
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+/**
+ * A rapidjson document whose allocator draws from an inline buffer. The arena is reset and
+ * reused instead of being freed, so documents that fit in the buffer never touch the heap.
+ */
+class DocumentArena {
+public:
+    static const size_t BUFFER_SIZE = 16 * 1024;
+
+    DocumentArena();
+
+    rapidjson::Document& getDocument() { return m_document; }
+
+    // scratch buffer owned by the arena, used as the source of in-situ parsing
+    std::string& getBuffer() { return m_buffer; }
+
+    void reset();
+
+private:
+    DocumentArena( const DocumentArena& ) = delete;
+    DocumentArena& operator=( const DocumentArena& ) = delete;
+
+    std::aligned_storage<BUFFER_SIZE>::type m_chunk;
+    rapidjson::MemoryPoolAllocator<> m_allocator;
+    rapidjson::Document m_document;
+    std::string m_buffer;
+};
+
+/**
+ * Hands out pooled arenas. A released arena goes back to the cache of the thread that created it,
+ * also when it is released on another worker, so acquiring and releasing never take a lock.
+ */
+class DocumentPool {
+public:
+    static std::shared_ptr<DocumentArena> acquireArena();
+
+    /**
+     * Returns a pooled document. The document keeps its arena alive and returns it to the pool when released.
+     */
+    static std::shared_ptr<rapidjson::Document> acquire();
+};
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
+
+#endif // AACE_ENGINE_LOCAL_SKILL_SERVICE_DOCUMENT_POOL_H
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "AACE/Engine/LocalSkillService/EndpointProber.h"
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+// bounds the number of sockets open at once; larger sets are probed in rounds of this size
+static const size_t MAX_CONCURRENT_PROBES = 256;
+
+static EndpointProber::Result getResult( int error ) {
+    switch ( error ) {
+        case 0:
+        // the listen backlog is full, so there is a listener
+        case EAGAIN:
+            return EndpointProber::Result::LISTENING;
+        // missing sockets, refused connects and errors such as EACCES while a skill is still setting up
+        // its socket may all clear up, so they run through the grace period
+        default:
+            return EndpointProber::Result::NOT_LISTENING;
+    }
+}
+
+std::vector<EndpointProber::Result> EndpointProber::probe( const std::vector<std::string>& endpoints, std::chrono::milliseconds timeout ) {
+    std::vector<Result> results( endpoints.size(), Result::NOT_LISTENING );
+    for ( size_t first = 0; first < endpoints.size(); first += MAX_CONCURRENT_PROBES ) {
+        size_t last = std::min( endpoints.size(), first + MAX_CONCURRENT_PROBES );
+        // connects that did not complete immediately, with the index of their endpoint
+        std::vector<pollfd> inProgress;
+        std::vector<size_t> indexes;
+        for ( size_t index = first; index < last; index++ ) {
+            sockaddr_un address;
+            std::memset( &address, 0, sizeof( address ) );
+            address.sun_family = AF_UNIX;
+            if ( endpoints[ index ].empty() || endpoints[ index ].size() >= sizeof( address.sun_path ) ) {
+                results[ index ] = Result::UNREACHABLE;
+                continue;
+            }
+            std::memcpy( address.sun_path, endpoints[ index ].c_str(), endpoints[ index ].size() );
+            int fd = socket( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 );
+            if ( fd < 0 ) {
+                // out of descriptors; try again on the next probe
+                results[ index ] = Result::NOT_LISTENING;
+                continue;
+            }
+            if ( connect( fd, reinterpret_cast<sockaddr*>( &address ), sizeof( address ) ) == 0 ) {
+                results[ index ] = Result::LISTENING;
+            }
+            else if ( errno == EINPROGRESS ) {
+                pollfd entry;
+                entry.fd = fd;
+                entry.events = POLLOUT;
+                entry.revents = 0;
+                inProgress.push_back( entry );
+                indexes.push_back( index );
+                continue;
+            }
+            else {
+                results[ index ] = getResult( errno );
+            }
+            close( fd );
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        size_t remaining = inProgress.size();
+        while ( remaining > 0 ) {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>( deadline - std::chrono::steady_clock::now() ).count();
+            if ( wait <= 0 || poll( inProgress.data(), inProgress.size(), static_cast<int>( wait ) ) <= 0 ) {
+                break;
+            }
+            for ( size_t item = 0; item < inProgress.size(); item++ ) {
+                auto& entry = inProgress[ item ];
+                if ( entry.fd < 0 || entry.revents == 0 ) {
+                    continue;
+                }
+                int error = 0;
+                socklen_t length = sizeof( error );
+                if ( getsockopt( entry.fd, SOL_SOCKET, SO_ERROR, &error, &length ) < 0 ) {
+                    error = errno;
+                }
+                results[ indexes[ item ] ] = getResult( error );
+                close( entry.fd );
+                // poll ignores negative descriptors
+                entry.fd = -1;
+                remaining--;
+            }
+        }
+        for ( auto& entry : inProgress ) {
+            if ( entry.fd >= 0 ) {
+                close( entry.fd );
+            }
+        }
+    }
+    return results;
+}
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOCAL_SKILL_SERVICE_ENDPOINT_PROBER_H
+#define AACE_ENGINE_LOCAL_SKILL_SERVICE_ENDPOINT_PROBER_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+/**
+ * Checks whether anything is listening on a set of UNIX socket endpoints. Every endpoint gets a
+ * non-blocking connect at once and the connection is closed again without sending a request.
+ */
+class EndpointProber {
+public:
+    enum class Result {
+        // a server accepted the connection or has it queued
+        LISTENING,
+        // no socket at the path yet, nobody listening on it, or the connect failed for another reason
+        NOT_LISTENING,
+        // the endpoint is not a valid socket path: empty or too long
+        UNREACHABLE
+    };
+
+    /**
+     * Probes @c endpoints and returns one result per endpoint, in the same order. Connects still in
+     * progress after @c timeout count as not listening.
+     */
+    static std::vector<Result> probe( const std::vector<std::string>& endpoints, std::chrono::milliseconds timeout );
+};
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
+
+#endif // AACE_ENGINE_LOCAL_SKILL_SERVICE_ENDPOINT_PROBER_H
@@ -0,0 +1,712 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "AACE/Engine/LocalSkillService/HttpServer.h"
+#include "AACE/Engine/Core/EngineMacros.h"
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+// String to identify log entries originating from this file.
+static const std::string TAG("aace.localSkillService.HttpServer");
+
+// epoll identifiers of the listening socket and the wake-up eventfd; connections are numbered after them
+static const uint64_t LISTEN_ID = 0;
+static const uint64_t WAKE_ID = 1;
+
+static const int LISTEN_BACKLOG = 128;
+static const int MAX_EVENTS = 64;
+static const size_t READ_CHUNK_SIZE = 16 * 1024;
+
+// requests with larger headers or bodies are rejected
+static const size_t MAX_HEADER_SIZE = 16 * 1024;
+static const size_t MAX_BODY_SIZE = 4 * 1024 * 1024;
+
+// pipelined requests dispatched per connection before reading pauses for their responses
+static const uint64_t MAX_PIPELINED_REQUESTS = 32;
+
+static const std::chrono::milliseconds DEFAULT_IDLE_TIMEOUT( 30000 );
+static const size_t DEFAULT_MAX_REQUESTS_PER_CONNECTION = 1000;
+
+// reading stops while this many requests of a connection await their response, so the socket applies backpressure
+static bool isReadPaused( uint64_t nextRequest, uint64_t nextResponse ) {
+    return nextRequest - nextResponse >= MAX_PIPELINED_REQUESTS;
+}
+
+static const char* reasonPhrase( int status ) {
+    switch ( status ) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        default: return "Unknown";
+    }
+}
+
+static std::string formatResponse( int status, const std::string& body, bool keepAlive ) {
+    std::string data = "HTTP/1.1 " + std::to_string( status ) + " " + reasonPhrase( status ) + "\r\n";
+    if ( !body.empty() ) {
+        data += "Content-Type: application/json\r\n";
+    }
+    data += "Content-Length: " + std::to_string( body.size() ) + "\r\n";
+    data += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    data += body;
+    return data;
+}
+
+static std::string toLower( std::string value ) {
+    std::transform( value.begin(), value.end(), value.begin(), []( unsigned char c ) { return static_cast<char>( std::tolower( c ) ); } );
+    return value;
+}
+
+static std::string trim( const std::string& value ) {
+    auto begin = value.find_first_not_of( " \t" );
+    if ( begin == std::string::npos ) {
+        return "";
+    }
+    auto end = value.find_last_not_of( " \t" );
+    return value.substr( begin, end - begin + 1 );
+}
+
+//
+// HttpRequest
+//
+
+HttpRequest::HttpRequest( std::weak_ptr<HttpServer> server, uint64_t connectionId, uint64_t sequence, bool keepAlive, CancellationToken cancellationToken, std::string method, std::string path, std::unordered_map<std::string, std::string> headers, std::string body ) :
+    m_server( server ),
+    m_connectionId( connectionId ),
+    m_sequence( sequence ),
+    m_keepAlive( keepAlive ),
+    m_cancellationToken( cancellationToken ),
+    m_method( std::move( method ) ),
+    m_path( std::move( path ) ),
+    m_headers( std::move( headers ) ),
+    m_body( std::move( body ) ),
+    m_responded( false ) {
+}
+
+std::string HttpRequest::getHeader( const std::string& name ) const {
+    auto it = m_headers.find( toLower( name ) );
+    return it != m_headers.end() ? it->second : "";
+}
+
+void HttpRequest::respond( int status, const std::string& body ) {
+    if ( m_responded.exchange( true ) ) {
+        AACE_WARN(LX(TAG).d("path", m_path).d("status", status).d("reason", "alreadyResponded"));
+        return;
+    }
+    auto server = m_server.lock();
+    if ( server ) {
+        server->send( m_connectionId, m_sequence, formatResponse( status, body, m_keepAlive ), !m_keepAlive );
+    }
+}
+
+//
+// HttpServer
+//
+
+std::shared_ptr<HttpServer> HttpServer::create( const std::string& socketPath, int pollTimeoutMs ) {
+    try {
+        ThrowIf( socketPath.empty(), "invalidSocketPath" );
+        ThrowIf( socketPath.size() >= sizeof( sockaddr_un::sun_path ), "socketPathTooLong" );
+        return std::shared_ptr<HttpServer>( new HttpServer( socketPath, -1, pollTimeoutMs ) );
+    }
+    catch( std::exception& ex ) {
+        AACE_ERROR(LX(TAG).d("socketPath", socketPath).d("reason", ex.what()));
+        return nullptr;
+    }
+}
+
+std::shared_ptr<HttpServer> HttpServer::createFromListenFd( int listenFd, int pollTimeoutMs ) {
+    try {
+        ThrowIf( listenFd < 0, "invalidListenFd" );
+        int type = 0;
+        int listening = 0;
+        socklen_t length = sizeof( type );
+        ThrowIf( getsockopt( listenFd, SOL_SOCKET, SO_TYPE, &type, &length ) < 0, "notASocket" );
+        ThrowIf( type != SOCK_STREAM, "notAStreamSocket" );
+        length = sizeof( listening );
+        ThrowIf( getsockopt( listenFd, SOL_SOCKET, SO_ACCEPTCONN, &listening, &length ) < 0 || listening == 0, "socketNotListening" );
+
+        // the service is only ever served on a local socket, never over the network
+        sockaddr_storage storage;
+        std::memset( &storage, 0, sizeof( storage ) );
+        length = sizeof( storage );
+        ThrowIf( getsockname( listenFd, reinterpret_cast<sockaddr*>( &storage ), &length ) < 0, "getSocketNameFailed" );
+        ThrowIf( storage.ss_family != AF_UNIX, "notAUnixSocket" );
+
+        // the event loop expects the same flags as a socket it created itself
+        int flags = fcntl( listenFd, F_GETFL );
+        ThrowIf( flags < 0 || fcntl( listenFd, F_SETFL, flags | O_NONBLOCK ) < 0, "setNonBlockingFailed" );
+        ThrowIf( fcntl( listenFd, F_SETFD, FD_CLOEXEC ) < 0, "setCloseOnExecFailed" );
+
+        // the path is only used for logging
+        auto& address = reinterpret_cast<const sockaddr_un&>( storage );
+        std::string socketPath( address.sun_path, strnlen( address.sun_path, sizeof( address.sun_path ) ) );
+        return std::shared_ptr<HttpServer>( new HttpServer( socketPath, listenFd, pollTimeoutMs ) );
+    }
+    catch( std::exception& ex ) {
+        AACE_ERROR(LX(TAG).d("listenFd", listenFd).d("reason", ex.what()).d("errno", errno));
+        return nullptr;
+    }
+}
+
+HttpServer::HttpServer( const std::string& socketPath, int inheritedFd, int pollTimeoutMs ) :
+    m_socketPath( socketPath ),
+    m_inheritedFd( inheritedFd ),
+    m_pollTimeoutMs( pollTimeoutMs ),
+    m_idleTimeout( DEFAULT_IDLE_TIMEOUT ),
+    m_maxRequestsPerConnection( DEFAULT_MAX_REQUESTS_PER_CONNECTION ),
+    m_listenFd( -1 ),
+    m_epollFd( -1 ),
+    m_wakeFd( -1 ),
+    m_running( false ),
+    m_nextConnectionId( WAKE_ID + 1 ) {
+}
+
+HttpServer::~HttpServer() {
+    stop();
+    if ( m_inheritedFd >= 0 ) {
+        close( m_inheritedFd );
+    }
+}
+
+void HttpServer::setRequestHandler( RequestHandler handler ) {
+    m_requestHandler = handler;
+}
+
+void HttpServer::setIdleTimeout( std::chrono::milliseconds idleTimeout ) {
+    m_idleTimeout = idleTimeout;
+}
+
+void HttpServer::setMaxRequestsPerConnection( size_t maxRequests ) {
+    m_maxRequestsPerConnection = maxRequests;
+}
+
+bool HttpServer::start() {
+    try {
+        ThrowIf( m_running, "alreadyStarted" );
+
+        if ( m_inheritedFd >= 0 ) {
+            m_listenFd = m_inheritedFd;
+        }
+        else {
+            m_listenFd = socket( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 );
+            ThrowIf( m_listenFd < 0, "createSocketFailed" );
+            sockaddr_un address;
+            std::memset( &address, 0, sizeof( address ) );
+            address.sun_family = AF_UNIX;
+            std::strncpy( address.sun_path, m_socketPath.c_str(), sizeof( address.sun_path ) - 1 );
+            // remove a socket file left behind by a previous run
+            unlink( m_socketPath.c_str() );
+            ThrowIf( bind( m_listenFd, reinterpret_cast<sockaddr*>( &address ), sizeof( address ) ) < 0, "bindFailed" );
+            ThrowIf( listen( m_listenFd, LISTEN_BACKLOG ) < 0, "listenFailed" );
+        }
+
+        m_epollFd = epoll_create1( EPOLL_CLOEXEC );
+        ThrowIf( m_epollFd < 0, "createEpollFailed" );
+        m_wakeFd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+        ThrowIf( m_wakeFd < 0, "createEventFdFailed" );
+
+        epoll_event event;
+        std::memset( &event, 0, sizeof( event ) );
+        event.events = EPOLLIN;
+        event.data.u64 = LISTEN_ID;
+        ThrowIf( epoll_ctl( m_epollFd, EPOLL_CTL_ADD, m_listenFd, &event ) < 0, "addListenSocketFailed" );
+        event.data.u64 = WAKE_ID;
+        ThrowIf( epoll_ctl( m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &event ) < 0, "addEventFdFailed" );
+
+        m_running = true;
+        m_thread = std::thread( &HttpServer::run, this );
+        return true;
+    }
+    catch( std::exception& ex ) {
+        AACE_ERROR(LX(TAG).d("socketPath", m_socketPath).d("reason", ex.what()).d("errno", errno));
+        closeSockets();
+        return false;
+    }
+}
+
+void HttpServer::stop() {
+    if ( !m_running.exchange( false ) ) {
+        return;
+    }
+    uint64_t value = 1;
+    if ( write( m_wakeFd, &value, sizeof( value ) ) < 0 ) {
+        AACE_WARN(LX(TAG).d("reason", "wakeFailed").d("errno", errno));
+    }
+    if ( m_thread.joinable() ) {
+        m_thread.join();
+    }
+    closeSockets();
+    // an inherited socket belongs to whoever created it
+    if ( m_inheritedFd < 0 ) {
+        unlink( m_socketPath.c_str() );
+    }
+}
+
+void HttpServer::closeSockets() {
+    for ( auto& it : m_connections ) {
+        it.second->cancelled->store( true );
+        close( it.second->fd );
+    }
+    m_connections.clear();
+    m_idleOrder.clear();
+    // an inherited socket stays open so the server can be started again
+    if ( m_listenFd == m_inheritedFd ) {
+        m_listenFd = -1;
+    }
+    for ( int* fd : { &m_listenFd, &m_epollFd } ) {
+        if ( *fd >= 0 ) {
+            close( *fd );
+            *fd = -1;
+        }
+    }
+    std::lock_guard<std::mutex> guard( m_pendingMutex );
+    if ( m_wakeFd >= 0 ) {
+        close( m_wakeFd );
+        m_wakeFd = -1;
+    }
+    m_pendingResponses.clear();
+}
+
+void HttpServer::send( uint64_t connectionId, uint64_t sequence, std::string data, bool close ) {
+    // handlers may still answer after stop(); the wake fd is only used and closed under this lock
+    std::lock_guard<std::mutex> guard( m_pendingMutex );
+    if ( !m_running || m_wakeFd < 0 ) {
+        return;
+    }
+    m_pendingResponses.push_back( PendingResponse{ connectionId, sequence, std::move( data ), close } );
+    uint64_t value = 1;
+    if ( write( m_wakeFd, &value, sizeof( value ) ) < 0 && errno != EAGAIN ) {
+        AACE_WARN(LX(TAG).d("reason", "wakeFailed").d("errno", errno));
+    }
+}
+
+void HttpServer::run() {
+    epoll_event events[ MAX_EVENTS ];
+    while ( m_running ) {
+        int count = epoll_wait( m_epollFd, events, MAX_EVENTS, getWaitTimeout() );
+        if ( count < 0 ) {
+            if ( errno == EINTR ) {
+                continue;
+            }
+            AACE_ERROR(LX(TAG).d("reason", "epollWaitFailed").d("errno", errno));
+            break;
+        }
+        for ( int index = 0; index < count && m_running; index++ ) {
+            auto id = events[ index ].data.u64;
+            auto flags = events[ index ].events;
+            if ( id == LISTEN_ID ) {
+                acceptConnections();
+                continue;
+            }
+            if ( id == WAKE_ID ) {
+                uint64_t value;
+                while ( read( m_wakeFd, &value, sizeof( value ) ) > 0 );
+                flushResponses();
+                continue;
+            }
+            auto it = m_connections.find( id );
+            if ( it == m_connections.end() ) {
+                continue;
+            }
+            auto& connection = *it->second;
+            if ( flags & ( EPOLLERR | EPOLLHUP ) ) {
+                // a request written right before the peer hung up is still buffered in the socket
+                if ( ( flags & EPOLLIN ) && !( flags & EPOLLERR ) ) {
+                    readConnection( connection );
+                    hangUpConnection( id );
+                }
+                else {
+                    closeConnection( id );
+                }
+                continue;
+            }
+            if ( ( flags & EPOLLOUT ) && !writeConnection( connection ) ) {
+                continue;
+            }
+            if ( flags & ( EPOLLIN | EPOLLRDHUP ) ) {
+                readConnection( connection );
+            }
+        }
+        closeIdleConnections();
+    }
+}
+
+int HttpServer::getWaitTimeout() {
+    if ( m_idleOrder.empty() || m_idleTimeout.count() <= 0 ) {
+        return m_pollTimeoutMs;
+    }
+    // wake up in time to expire the least recently active connection
+    auto& oldest = *m_connections[ m_idleOrder.front() ];
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>( oldest.lastActivity + m_idleTimeout - std::chrono::steady_clock::now() ).count() + 1;
+    int timeout = static_cast<int>( std::max<long long>( 0, std::min<long long>( remaining, std::numeric_limits<int>::max() ) ) );
+    return m_pollTimeoutMs >= 0 ? std::min( timeout, m_pollTimeoutMs ) : timeout;
+}
+
+void HttpServer::closeIdleConnections() {
+    if ( m_idleTimeout.count() <= 0 ) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    while ( !m_idleOrder.empty() ) {
+        auto& connection = *m_connections[ m_idleOrder.front() ];
+        if ( connection.lastActivity + m_idleTimeout > now ) {
+            return;
+        }
+        if ( connection.nextRequest != connection.nextResponse || !connection.output.empty() ) {
+            // still serving a request, so it is not idle
+            touchConnection( connection );
+            continue;
+        }
+        AACE_DEBUG(LX(TAG).d("connection", connection.id).m("idleTimeout"));
+        closeConnection( connection.id );
+    }
+}
+
+void HttpServer::acceptConnections() {
+    for ( ;; ) {
+        int fd = accept4( m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC );
+        if ( fd < 0 ) {
+            if ( errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR ) {
+                AACE_ERROR(LX(TAG).d("reason", "acceptFailed").d("errno", errno));
+            }
+            return;
+        }
+        std::unique_ptr<Connection> connection( new Connection() );
+        connection->fd = fd;
+        connection->id = m_nextConnectionId++;
+        connection->nextRequest = 0;
+        connection->nextResponse = 0;
+        connection->requestCount = 0;
+        connection->closing = false;
+        connection->readClosed = false;
+        connection->events = EPOLLIN | EPOLLRDHUP;
+        connection->hungUp = false;
+        connection->cancelled = std::make_shared<std::atomic<bool>>( false );
+        epoll_event event;
+        std::memset( &event, 0, sizeof( event ) );
+        event.events = connection->events;
+        event.data.u64 = connection->id;
+        if ( epoll_ctl( m_epollFd, EPOLL_CTL_ADD, fd, &event ) < 0 ) {
+            AACE_ERROR(LX(TAG).d("reason", "addConnectionFailed").d("errno", errno));
+            close( fd );
+            continue;
+        }
+        connection->lastActivity = std::chrono::steady_clock::now();
+        connection->idlePosition = m_idleOrder.insert( m_idleOrder.end(), connection->id );
+        m_connections.emplace( connection->id, std::move( connection ) );
+    }
+}
+
+void HttpServer::readConnection( Connection& connection ) {
+    auto id = connection.id;
+    char buffer[ READ_CHUNK_SIZE ];
+    // at most one maximal request is buffered per wakeup; level triggered epoll reports the rest
+    while ( !isReadPaused( connection.nextRequest, connection.nextResponse ) && connection.input.size() < MAX_HEADER_SIZE + MAX_BODY_SIZE ) {
+        auto count = read( connection.fd, buffer, sizeof( buffer ) );
+        if ( count > 0 ) {
+            connection.input.append( buffer, static_cast<size_t>( count ) );
+            continue;
+        }
+        if ( count < 0 && errno == EINTR ) {
+            continue;
+        }
+        if ( count < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK ) ) {
+            break;
+        }
+        if ( count < 0 ) {
+            closeConnection( id );
+            return;
+        }
+        // the peer finished sending; it may still be waiting for responses
+        connection.readClosed = true;
+        break;
+    }
+    touchConnection( connection );
+    if ( connection.closing ) {
+        connection.input.clear();
+    }
+    else if ( !parseRequests( connection ) ) {
+        return;
+    }
+    if ( connection.readClosed && connection.nextRequest == connection.nextResponse && connection.output.empty() ) {
+        closeConnection( id );
+        return;
+    }
+    // stops reading at the pipelining limit
+    updateEvents( connection );
+}
+
+// returns false if the connection was closed
+bool HttpServer::parseRequests( Connection& connection ) {
+    auto id = connection.id;
+    while ( !connection.closing && connection.nextRequest - connection.nextResponse < MAX_PIPELINED_REQUESTS ) {
+        if ( !parseRequest( connection ) ) {
+            break;
+        }
+        // a synchronous response may have closed the connection
+        if ( m_connections.find( id ) == m_connections.end() ) {
+            return false;
+        }
+    }
+    return m_connections.find( id ) != m_connections.end();
+}
+
+bool HttpServer::parseRequest( Connection& connection ) {
+    auto headerEnd = connection.input.find( "\r\n\r\n" );
+    if ( headerEnd == std::string::npos || headerEnd > MAX_HEADER_SIZE ) {
+        if ( connection.input.size() > MAX_HEADER_SIZE ) {
+            rejectRequest( connection, 431 );
+        }
+        return false;
+    }
+
+    // request line
+    auto lineEnd = connection.input.find( "\r\n" );
+    std::string requestLine = connection.input.substr( 0, lineEnd );
+    auto methodEnd = requestLine.find( ' ' );
+    auto targetEnd = methodEnd != std::string::npos ? requestLine.find( ' ', methodEnd + 1 ) : std::string::npos;
+    if ( targetEnd == std::string::npos ) {
+        rejectRequest( connection, 400 );
+        return false;
+    }
+    std::string method = requestLine.substr( 0, methodEnd );
+    std::string target = requestLine.substr( methodEnd + 1, targetEnd - methodEnd - 1 );
+    std::string version = requestLine.substr( targetEnd + 1 );
+    std::string path = target.substr( 0, target.find( '?' ) );
+
+    // headers
+    std::unordered_map<std::string, std::string> headers;
+    size_t position = lineEnd + 2;
+    while ( position < headerEnd ) {
+        auto end = connection.input.find( "\r\n", position );
+        auto line = connection.input.substr( position, end - position );
+        auto colon = line.find( ':' );
+        if ( colon != std::string::npos ) {
+            headers[ toLower( trim( line.substr( 0, colon ) ) ) ] = trim( line.substr( colon + 1 ) );
+        }
+        position = end + 2;
+    }
+    if ( headers.find( "transfer-encoding" ) != headers.end() ) {
+        rejectRequest( connection, 501 );
+        return false;
+    }
+
+    // body
+    size_t contentLength = 0;
+    auto length = headers.find( "content-length" );
+    if ( length != headers.end() ) {
+        // anything but plain digits would leave body bytes to be parsed as the next pipelined request
+        auto& value = length->second;
+        bool digits = !value.empty() && std::all_of( value.begin(), value.end(), []( char c ) { return std::isdigit( static_cast<unsigned char>( c ) ) != 0; } );
+        char* end = nullptr;
+        errno = 0;
+        auto parsed = digits ? std::strtoull( value.c_str(), &end, 10 ) : 0;
+        if ( !digits || errno != 0 || *end != '\0' ) {
+            rejectRequest( connection, 400 );
+            return false;
+        }
+        contentLength = parsed > MAX_BODY_SIZE ? MAX_BODY_SIZE + 1 : static_cast<size_t>( parsed );
+    }
+    if ( contentLength > MAX_BODY_SIZE ) {
+        rejectRequest( connection, 413 );
+        return false;
+    }
+    auto bodyStart = headerEnd + 4;
+    if ( connection.input.size() < bodyStart + contentLength ) {
+        return false;
+    }
+    std::string body = connection.input.substr( bodyStart, contentLength );
+    connection.input.erase( 0, bodyStart + contentLength );
+
+    // HTTP/1.1 connections persist unless either side asks to close; HTTP/1.0 ones only on request
+    auto connectionHeader = headers.find( "connection" );
+    std::string connectionOption = connectionHeader != headers.end() ? toLower( connectionHeader->second ) : "";
+    bool keepAlive = version == "HTTP/1.1" ? connectionOption != "close" : connectionOption == "keep-alive";
+    connection.requestCount++;
+    if ( m_idleTimeout.count() <= 0 || ( m_maxRequestsPerConnection > 0 && connection.requestCount >= m_maxRequestsPerConnection ) ) {
+        keepAlive = false;
+    }
+    if ( !keepAlive ) {
+        connection.closing = true;
+        connection.input.clear();
+    }
+
+    auto request = std::make_shared<HttpRequest>( shared_from_this(), connection.id, connection.nextRequest++, keepAlive, connection.cancelled, std::move( method ), std::move( path ), std::move( headers ), std::move( body ) );
+    if ( m_requestHandler ) {
+        m_requestHandler( request );
+    }
+    else {
+        request->respond( 404, "" );
+    }
+    return true;
+}
+
+void HttpServer::rejectRequest( Connection& connection, int status ) {
+    // malformed input leaves the stream position unknown, so nothing after it can be parsed
+    connection.closing = true;
+    connection.input.clear();
+    send( connection.id, connection.nextRequest++, formatResponse( status, "", false ), true );
+}
+
+void HttpServer::flushResponses() {
+    std::vector<PendingResponse> responses;
+    {
+        std::lock_guard<std::mutex> guard( m_pendingMutex );
+        responses.swap( m_pendingResponses );
+    }
+    for ( auto& response : responses ) {
+        auto it = m_connections.find( response.connectionId );
+        if ( it == m_connections.end() ) {
+            // the client went away before the response was ready
+            continue;
+        }
+        auto& connection = *it->second;
+        // reading may have paused at the pipelining limit; parse what is buffered and resume reading
+        if ( completeResponse( connection, response.sequence, std::move( response.data ), response.close ) && parseRequests( connection ) ) {
+            updateEvents( connection );
+        }
+    }
+}
+
+// returns false if the connection was closed
+bool HttpServer::completeResponse( Connection& connection, uint64_t sequence, std::string data, bool close ) {
+    connection.completed.emplace( sequence, std::make_pair( std::move( data ), close ) );
+    // responses are released strictly in request order
+    auto it = connection.completed.begin();
+    while ( it != connection.completed.end() && it->first == connection.nextResponse ) {
+        connection.output += it->second.first;
+        if ( it->second.second ) {
+            connection.closing = true;
+        }
+        connection.nextResponse++;
+        it = connection.completed.erase( it );
+    }
+    return writeConnection( connection );
+}
+
+// returns false if the connection was closed
+bool HttpServer::writeConnection( Connection& connection ) {
+    while ( !connection.output.empty() ) {
+        auto count = ::send( connection.fd, connection.output.data(), connection.output.size(), MSG_NOSIGNAL );
+        if ( count > 0 ) {
+            connection.output.erase( 0, static_cast<size_t>( count ) );
+            touchConnection( connection );
+            continue;
+        }
+        if ( count < 0 && errno == EINTR ) {
+            continue;
+        }
+        if ( count < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK ) ) {
+            // wait for the socket to drain before writing the rest
+            updateEvents( connection );
+            return true;
+        }
+        closeConnection( connection.id );
+        return false;
+    }
+    if ( ( connection.closing || connection.readClosed ) && connection.nextRequest == connection.nextResponse ) {
+        closeConnection( connection.id );
+        return false;
+    }
+    updateEvents( connection );
+    return true;
+}
+
+void HttpServer::touchConnection( Connection& connection ) {
+    connection.lastActivity = std::chrono::steady_clock::now();
+    m_idleOrder.splice( m_idleOrder.end(), m_idleOrder, connection.idlePosition );
+}
+
+void HttpServer::updateEvents( Connection& connection ) {
+    if ( connection.hungUp ) {
+        return;
+    }
+    epoll_event event;
+    std::memset( &event, 0, sizeof( event ) );
+    bool reading = !connection.readClosed && !isReadPaused( connection.nextRequest, connection.nextResponse );
+    uint32_t events = reading ? EPOLLIN | EPOLLRDHUP : 0;
+    if ( !connection.output.empty() ) {
+        events |= EPOLLOUT;
+    }
+    if ( events == connection.events ) {
+        return;
+    }
+    connection.events = events;
+    event.events = events;
+    event.data.u64 = connection.id;
+    if ( epoll_ctl( m_epollFd, EPOLL_CTL_MOD, connection.fd, &event ) < 0 ) {
+        AACE_WARN(LX(TAG).d("reason", "updateEventsFailed").d("errno", errno));
+    }
+}
+
+void HttpServer::hangUpConnection( uint64_t connectionId ) {
+    auto it = m_connections.find( connectionId );
+    if ( it == m_connections.end() ) {
+        return;
+    }
+    auto& connection = *it->second;
+    if ( connection.nextRequest == connection.nextResponse ) {
+        closeConnection( connectionId );
+        return;
+    }
+    // a hung up socket stays readable forever, so it leaves the epoll set while its requests are still handled;
+    // writing their responses then fails and closes the connection
+    if ( epoll_ctl( m_epollFd, EPOLL_CTL_DEL, connection.fd, nullptr ) < 0 ) {
+        AACE_WARN(LX(TAG).d("reason", "removeConnectionFailed").d("errno", errno));
+    }
+    connection.hungUp = true;
+    connection.readClosed = true;
+}
+
+void HttpServer::closeConnection( uint64_t connectionId ) {
+    auto it = m_connections.find( connectionId );
+    if ( it == m_connections.end() ) {
+        return;
+    }
+    // requests still being handled for this connection can no longer be answered
+    it->second->cancelled->store( true );
+    // closing the descriptor also removes it from the epoll set
+    close( it->second->fd );
+    m_idleOrder.erase( it->second->idlePosition );
+    m_connections.erase( it );
+}
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOCAL_SKILL_SERVICE_HTTP_SERVER_H
+#define AACE_ENGINE_LOCAL_SKILL_SERVICE_HTTP_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+class HttpServer;
+
+/**
+ * A single request received by the HttpServer. The response may be sent from any thread;
+ * only the first call to respond() has an effect.
+ */
+class HttpRequest {
+public:
+    // set once the connection the request arrived on is gone
+    using CancellationToken = std::shared_ptr<const std::atomic<bool>>;
+
+    HttpRequest( std::weak_ptr<HttpServer> server, uint64_t connectionId, uint64_t sequence, bool keepAlive, CancellationToken cancellationToken, std::string method, std::string path, std::unordered_map<std::string, std::string> headers, std::string body );
+
+    const std::string& getMethod() const { return m_method; }
+    const std::string& getPath() const { return m_path; }
+    const std::string& getBody() const { return m_body; }
+
+    /**
+     * Moves the body out of the request, leaving it empty.
+     */
+    std::string takeBody() { return std::move( m_body ); }
+
+    /**
+     * Returns the value of a request header, matched case-insensitively, or an empty string.
+     */
+    std::string getHeader( const std::string& name ) const;
+
+    void respond( int status, const std::string& body );
+
+    /**
+     * Returns true once the client disconnected, after which nobody will read the response.
+     */
+    bool isCancelled() const { return m_cancellationToken->load(); }
+    const CancellationToken& getCancellationToken() const { return m_cancellationToken; }
+
+private:
+    std::weak_ptr<HttpServer> m_server;
+    uint64_t m_connectionId;
+    // position of the request on its connection; responses are written in this order
+    uint64_t m_sequence;
+    bool m_keepAlive;
+    CancellationToken m_cancellationToken;
+    std::string m_method;
+    std::string m_path;
+    // keyed by lowercase header name
+    std::unordered_map<std::string, std::string> m_headers;
+    std::string m_body;
+    std::atomic<bool> m_responded;
+};
+
+/**
+ * HTTP/1.1 server on a UNIX domain socket. Accepting, reading and writing are driven by epoll
+ * readiness on a single thread, so idle connections cost nothing and many skills can stay connected.
+ * Connections are persistent and may pipeline requests; responses are always written in request order.
+ */
+class HttpServer : public std::enable_shared_from_this<HttpServer> {
+public:
+    using RequestHandler = std::function<void(std::shared_ptr<HttpRequest>)>;
+
+    /**
+     * Creates a server bound to @c socketPath. @c pollTimeoutMs bounds a single wait for readiness;
+     * the default of -1 waits until there is work, since responses and stop() wake the loop directly.
+     */
+    static std::shared_ptr<HttpServer> create( const std::string& socketPath, int pollTimeoutMs = -1 );
+
+    /**
+     * Creates a server on an inherited socket that is already bound and listening, as passed by systemd
+     * socket activation. Connections queued on it before start() are served once the server starts.
+     * The server takes ownership of @c listenFd; it stays open across stop() and the socket file is never unlinked.
+     */
+    static std::shared_ptr<HttpServer> createFromListenFd( int listenFd, int pollTimeoutMs = -1 );
+
+    ~HttpServer();
+
+    /**
+     * Sets the handler for incoming requests. It runs on the event loop thread and must hand
+     * any real work off to an executor.
+     */
+    void setRequestHandler( RequestHandler handler );
+
+    /**
+     * Sets how long a persistent connection without outstanding requests is kept open. Zero disables
+     * keep-alive, closing every connection after its first response. Must be called before start().
+     */
+    void setIdleTimeout( std::chrono::milliseconds idleTimeout );
+
+    /**
+     * Sets the number of requests served on one connection before it is closed, 0 for no limit.
+     * Must be called before start().
+     */
+    void setMaxRequestsPerConnection( size_t maxRequests );
+
+    bool start();
+    void stop();
+
+private:
+    HttpServer( const std::string& socketPath, int inheritedFd, int pollTimeoutMs );
+
+    friend class HttpRequest;
+
+    struct Connection {
+        int fd;
+        uint64_t id;
+        std::string input;
+        std::string output;
+        // sequence numbers of the next request to dispatch and the next response to write
+        uint64_t nextRequest;
+        uint64_t nextResponse;
+        // responses that finished ahead of an earlier pipelined request, with their close flag
+        std::map<uint64_t, std::pair<std::string, bool>> completed;
+        size_t requestCount;
+        // no further requests are read; the connection closes once the outstanding responses are written
+        bool closing;
+        // the peer shut down its side; no more input will arrive
+        bool readClosed;
+        // epoll events currently registered for the connection
+        uint32_t events;
+        // the peer is gone and the socket left the epoll set; the connection stays until its requests finish
+        bool hungUp;
+        std::chrono::steady_clock::time_point lastActivity;
+        // shared with the requests of the connection and set when it closes
+        std::shared_ptr<std::atomic<bool>> cancelled;
+        std::list<uint64_t>::iterator idlePosition;
+    };
+
+    struct PendingResponse {
+        uint64_t connectionId;
+        uint64_t sequence;
+        std::string data;
+        bool close;
+    };
+
+    // queues a serialized response for the connection and wakes the event loop
+    void send( uint64_t connectionId, uint64_t sequence, std::string data, bool close );
+
+    void run();
+    int getWaitTimeout();
+    void closeIdleConnections();
+    void acceptConnections();
+    void readConnection( Connection& connection );
+    bool writeConnection( Connection& connection );
+    void flushResponses();
+    bool completeResponse( Connection& connection, uint64_t sequence, std::string data, bool close );
+    bool parseRequests( Connection& connection );
+    bool parseRequest( Connection& connection );
+    void rejectRequest( Connection& connection, int status );
+    void touchConnection( Connection& connection );
+    void updateEvents( Connection& connection );
+    void hangUpConnection( uint64_t connectionId );
+    void closeConnection( uint64_t connectionId );
+    void closeSockets();
+
+private:
+    std::string m_socketPath;
+    // listening socket handed over by the process that started us, or -1 to bind m_socketPath
+    int m_inheritedFd;
+    int m_pollTimeoutMs;
+    RequestHandler m_requestHandler;
+    std::chrono::milliseconds m_idleTimeout;
+    size_t m_maxRequestsPerConnection;
+
+    int m_listenFd;
+    int m_epollFd;
+    // wakes the event loop for queued responses and shutdown
+    int m_wakeFd;
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+
+    // owned by the event loop thread
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> m_connections;
+    // connection ids, least recently active first
+    std::list<uint64_t> m_idleOrder;
+    uint64_t m_nextConnectionId;
+
+    std::vector<PendingResponse> m_pendingResponses;
+    std::mutex m_pendingMutex;
+};
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
+
+#endif // AACE_ENGINE_LOCAL_SKILL_SERVICE_HTTP_SERVER_H
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOCAL_SKILL_SERVICE_INPLACE_TASK_H
+#define AACE_ENGINE_LOCAL_SKILL_SERVICE_INPLACE_TASK_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+/**
+ * Move-only, type-erased @c void() callable stored inline in @c Capacity bytes. Unlike
+ * @c std::function it never allocates; callables that do not fit are rejected at compile time.
+ */
+template <size_t Capacity>
+class InplaceTask {
+public:
+    InplaceTask() : m_ops( nullptr ) {}
+
+    template <typename F, typename Fn = typename std::decay<F>::type, typename = typename std::enable_if<!std::is_same<Fn, InplaceTask>::value>::type>
+    InplaceTask( F&& function ) : m_ops( &OpsFor<Fn>::ops ) {
+        static_assert( sizeof( Fn ) <= Capacity, "task does not fit the inline storage" );
+        static_assert( alignof( Fn ) <= alignof( Storage ), "task alignment not supported" );
+        new ( &m_storage ) Fn( std::forward<F>( function ) );
+    }
+
+    InplaceTask( InplaceTask&& other ) : m_ops( other.m_ops ) {
+        if ( m_ops != nullptr ) {
+            m_ops->move( &m_storage, &other.m_storage );
+            other.m_ops = nullptr;
+        }
+    }
+
+    InplaceTask& operator=( InplaceTask&& other ) {
+        if ( this != &other ) {
+            reset();
+            m_ops = other.m_ops;
+            if ( m_ops != nullptr ) {
+                m_ops->move( &m_storage, &other.m_storage );
+                other.m_ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    ~InplaceTask() {
+        reset();
+    }
+
+    void operator()() {
+        m_ops->invoke( &m_storage );
+    }
+
+    explicit operator bool() const {
+        return m_ops != nullptr;
+    }
+
+    void reset() {
+        if ( m_ops != nullptr ) {
+            m_ops->destroy( &m_storage );
+            m_ops = nullptr;
+        }
+    }
+
+private:
+    InplaceTask( const InplaceTask& ) = delete;
+    InplaceTask& operator=( const InplaceTask& ) = delete;
+
+    using Storage = typename std::aligned_storage<Capacity>::type;
+
+    struct Ops {
+        void (*invoke)( void* );
+        // move constructs into the destination and destroys the source
+        void (*move)( void*, void* );
+        void (*destroy)( void* );
+    };
+
+    template <typename Fn>
+    struct OpsFor {
+        static void invoke( void* storage ) {
+            ( *static_cast<Fn*>( storage ) )();
+        }
+        static void move( void* destination, void* source ) {
+            new ( destination ) Fn( std::move( *static_cast<Fn*>( source ) ) );
+            static_cast<Fn*>( source )->~Fn();
+        }
+        static void destroy( void* storage ) {
+            static_cast<Fn*>( storage )->~Fn();
+        }
+        static const Ops ops;
+    };
+
+    Storage m_storage;
+    const Ops* m_ops;
+};
+
+template <size_t Capacity>
+template <typename Fn>
+const typename InplaceTask<Capacity>::Ops InplaceTask<Capacity>::OpsFor<Fn>::ops = {
+    &InplaceTask<Capacity>::OpsFor<Fn>::invoke,
+    &InplaceTask<Capacity>::OpsFor<Fn>::move,
+    &InplaceTask<Capacity>::OpsFor<Fn>::destroy
+};
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
+
+#endif // AACE_ENGINE_LOCAL_SKILL_SERVICE_INPLACE_TASK_H
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "AACE/Engine/LocalSkillService/InstrumentedMutex.h"
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+InstrumentedMutex::InstrumentedMutex() : m_enabled( false ), m_holder( nullptr ) {
+}
+
+void InstrumentedMutex::setEnabled( bool enabled ) {
+    m_enabled.store( enabled, std::memory_order_relaxed );
+}
+
+bool InstrumentedMutex::isEnabled() const {
+    return m_enabled.load( std::memory_order_relaxed );
+}
+
+void InstrumentedMutex::lock( const char* site ) {
+    if ( !isEnabled() ) {
+        m_mutex.lock();
+        m_holder = nullptr;
+        return;
+    }
+    auto requested = std::chrono::steady_clock::now();
+    m_mutex.lock();
+    m_acquired = std::chrono::steady_clock::now();
+    // the site lookup happens under the lock so it never adds to the measured wait of other callers
+    m_holder = &getSite( site );
+    m_holder->wait.record( std::chrono::duration_cast<std::chrono::microseconds>( m_acquired - requested ) );
+}
+
+void InstrumentedMutex::unlock() {
+    if ( m_holder != nullptr ) {
+        m_holder->hold.record( std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - m_acquired ) );
+        m_holder = nullptr;
+    }
+    m_mutex.unlock();
+}
+
+InstrumentedMutex::SiteMetrics& InstrumentedMutex::getSite( const char* site ) {
+    std::lock_guard<std::mutex> guard( m_sitesMutex );
+    auto& metrics = m_sites[ site ];
+    if ( !metrics ) {
+        metrics.reset( new SiteMetrics() );
+    }
+    return *metrics;
+}
+
+rapidjson::Value InstrumentedMutex::toJson( rapidjson::Document::AllocatorType& allocator ) {
+    rapidjson::Value value( rapidjson::kObjectType );
+    std::lock_guard<std::mutex> guard( m_sitesMutex );
+    for ( auto& pair : m_sites ) {
+        rapidjson::Value site( rapidjson::kObjectType );
+        site.AddMember( "wait", pair.second->wait.toJson( allocator ), allocator );
+        site.AddMember( "hold", pair.second->hold.toJson( allocator ), allocator );
+        rapidjson::Value name( pair.first, allocator );
+        value.AddMember( name, site, allocator );
+    }
+    return value;
+}
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOCAL_SKILL_SERVICE_INSTRUMENTED_MUTEX_H
+#define AACE_ENGINE_LOCAL_SKILL_SERVICE_INSTRUMENTED_MUTEX_H
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <rapidjson/document.h>
+
+#include "AACE/Engine/LocalSkillService/LatencyHistogram.h"
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+/**
+ * Mutex that can record, per call site, how long callers waited to acquire it and how long they held it.
+ * Recording is off by default; while disabled a lock costs one extra relaxed load over a plain std::mutex.
+ * Call sites are identified by string literals and are normally taken through InstrumentedLock.
+ */
+class InstrumentedMutex {
+public:
+    InstrumentedMutex();
+
+    void setEnabled( bool enabled );
+    bool isEnabled() const;
+
+    void lock( const char* site );
+    void unlock();
+
+    /**
+     * Returns { site: { wait, hold } } for every call site that locked the mutex while recording was enabled.
+     */
+    rapidjson::Value toJson( rapidjson::Document::AllocatorType& allocator );
+
+private:
+    InstrumentedMutex( const InstrumentedMutex& ) = delete;
+    InstrumentedMutex& operator=( const InstrumentedMutex& ) = delete;
+
+    struct SiteMetrics {
+        LatencyHistogram wait;
+        LatencyHistogram hold;
+    };
+
+    struct SiteLess {
+        bool operator()( const char* lhs, const char* rhs ) const { return std::strcmp( lhs, rhs ) < 0; }
+    };
+
+    SiteMetrics& getSite( const char* site );
+
+    std::mutex m_mutex;
+    std::atomic<bool> m_enabled;
+
+    // written by the current holder only; null when the lock was taken without recording
+    SiteMetrics* m_holder;
+    std::chrono::steady_clock::time_point m_acquired;
+
+    std::map<const char*, std::unique_ptr<SiteMetrics>, SiteLess> m_sites;
+    std::mutex m_sitesMutex;
+};
+
+/**
+ * Scoped lock of an InstrumentedMutex on behalf of a named call site.
+ */
+class InstrumentedLock {
+public:
+    InstrumentedLock( InstrumentedMutex& mutex, const char* site ) : m_mutex( mutex ) {
+        m_mutex.lock( site );
+    }
+
+    ~InstrumentedLock() {
+        m_mutex.unlock();
+    }
+
+private:
+    InstrumentedLock( const InstrumentedLock& ) = delete;
+    InstrumentedLock& operator=( const InstrumentedLock& ) = delete;
+
+    InstrumentedMutex& m_mutex;
+};
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
+
+#endif // AACE_ENGINE_LOCAL_SKILL_SERVICE_INSTRUMENTED_MUTEX_H
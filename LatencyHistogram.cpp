@@ -0,0 +1,114 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "AACE/Engine/LocalSkillService/LatencyHistogram.h"
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+const unsigned LatencyHistogram::SUB_BUCKET_BITS;
+const uint64_t LatencyHistogram::SUB_BUCKET_COUNT;
+const unsigned LatencyHistogram::MAX_MAGNITUDE;
+const size_t LatencyHistogram::BUCKET_COUNT;
+
+LatencyHistogram::LatencyHistogram() : m_count( 0 ), m_sum( 0 ), m_max( 0 ) {
+    for ( auto& bucket : m_buckets ) {
+        bucket.store( 0, std::memory_order_relaxed );
+    }
+}
+
+size_t LatencyHistogram::getBucketIndex( uint64_t value ) {
+    // values below two sub-bucket ranges are counted exactly
+    if ( value < 2 * SUB_BUCKET_COUNT ) {
+        return static_cast<size_t>( value );
+    }
+    unsigned magnitude = 63 - static_cast<unsigned>( __builtin_clzll( value ) );
+    unsigned shift = magnitude - SUB_BUCKET_BITS;
+    uint64_t subBucket = ( value >> shift ) - SUB_BUCKET_COUNT;
+    return static_cast<size_t>( 2 * SUB_BUCKET_COUNT + ( magnitude - SUB_BUCKET_BITS - 1 ) * SUB_BUCKET_COUNT + subBucket );
+}
+
+uint64_t LatencyHistogram::getBucketUpperBound( size_t index ) {
+    if ( index < 2 * SUB_BUCKET_COUNT ) {
+        return index;
+    }
+    uint64_t offset = index - 2 * SUB_BUCKET_COUNT;
+    unsigned shift = static_cast<unsigned>( offset / SUB_BUCKET_COUNT ) + 1;
+    uint64_t lower = ( offset % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT ) << shift;
+    return lower + ( uint64_t( 1 ) << shift ) - 1;
+}
+
+void LatencyHistogram::record( std::chrono::microseconds value ) {
+    uint64_t micros = value.count() > 0 ? static_cast<uint64_t>( value.count() ) : 0;
+    micros = std::min( micros, ( uint64_t( 1 ) << ( MAX_MAGNITUDE + 1 ) ) - 1 );
+    m_buckets[ getBucketIndex( micros ) ].fetch_add( 1, std::memory_order_relaxed );
+    m_count.fetch_add( 1, std::memory_order_relaxed );
+    m_sum.fetch_add( micros, std::memory_order_relaxed );
+    uint64_t max = m_max.load( std::memory_order_relaxed );
+    while ( micros > max && !m_max.compare_exchange_weak( max, micros, std::memory_order_relaxed ) ) {
+    }
+}
+
+uint64_t LatencyHistogram::getCount() const {
+    return m_count.load( std::memory_order_relaxed );
+}
+
+std::chrono::microseconds LatencyHistogram::getMax() const {
+    return std::chrono::microseconds( m_max.load( std::memory_order_relaxed ) );
+}
+
+std::chrono::microseconds LatencyHistogram::getMean() const {
+    uint64_t count = getCount();
+    return std::chrono::microseconds( count > 0 ? m_sum.load( std::memory_order_relaxed ) / count : 0 );
+}
+
+std::chrono::microseconds LatencyHistogram::getPercentile( double percentile ) const {
+    uint64_t total = 0;
+    for ( auto& bucket : m_buckets ) {
+        total += bucket.load( std::memory_order_relaxed );
+    }
+    if ( total == 0 ) {
+        return std::chrono::microseconds( 0 );
+    }
+    auto target = static_cast<uint64_t>( std::max( 1.0, percentile / 100.0 * total + 0.5 ) );
+    uint64_t seen = 0;
+    for ( size_t index = 0; index < BUCKET_COUNT; index++ ) {
+        seen += m_buckets[ index ].load( std::memory_order_relaxed );
+        if ( seen >= target ) {
+            // never report more than was actually recorded
+            return std::min( std::chrono::microseconds( getBucketUpperBound( index ) ), getMax() );
+        }
+    }
+    return getMax();
+}
+
+rapidjson::Value LatencyHistogram::toJson( rapidjson::Document::AllocatorType& allocator ) const {
+    rapidjson::Value value( rapidjson::kObjectType );
+    value.AddMember( "count", getCount(), allocator );
+    value.AddMember( "mean", static_cast<int64_t>( getMean().count() ), allocator );
+    value.AddMember( "p50", static_cast<int64_t>( getPercentile( 50 ).count() ), allocator );
+    value.AddMember( "p90", static_cast<int64_t>( getPercentile( 90 ).count() ), allocator );
+    value.AddMember( "p99", static_cast<int64_t>( getPercentile( 99 ).count() ), allocator );
+    value.AddMember( "p999", static_cast<int64_t>( getPercentile( 99.9 ).count() ), allocator );
+    value.AddMember( "max", static_cast<int64_t>( getMax().count() ), allocator );
+    return value;
+}
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOCAL_SKILL_SERVICE_LATENCY_HISTOGRAM_H
+#define AACE_ENGINE_LOCAL_SKILL_SERVICE_LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <rapidjson/document.h>
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+/**
+ * Log-linear latency histogram in the style of HdrHistogram. Every power of two is split into
+ * 32 linear buckets, so recorded values keep about 3% precision from one microsecond up to hours.
+ * Recording is a single relaxed atomic increment and never blocks; readers see a near-consistent snapshot.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record( std::chrono::microseconds value );
+
+    uint64_t getCount() const;
+    std::chrono::microseconds getMax() const;
+    std::chrono::microseconds getMean() const;
+
+    /**
+     * Returns the highest value equivalent to the given percentile (0-100) of the recorded values.
+     */
+    std::chrono::microseconds getPercentile( double percentile ) const;
+
+    /**
+     * Returns { count, mean, p50, p90, p99, p999, max }, with latencies in microseconds.
+     */
+    rapidjson::Value toJson( rapidjson::Document::AllocatorType& allocator ) const;
+
+private:
+    LatencyHistogram( const LatencyHistogram& ) = delete;
+    LatencyHistogram& operator=( const LatencyHistogram& ) = delete;
+
+    static const unsigned SUB_BUCKET_BITS = 5;
+    static const uint64_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    // values are clamped to 2^( MAX_MAGNITUDE + 1 ) - 1 microseconds, roughly 38 hours
+    static const unsigned MAX_MAGNITUDE = 36;
+    static const size_t BUCKET_COUNT = 2 * SUB_BUCKET_COUNT + ( MAX_MAGNITUDE - SUB_BUCKET_BITS ) * SUB_BUCKET_COUNT;
+
+    static size_t getBucketIndex( uint64_t value );
+    static uint64_t getBucketUpperBound( size_t index );
+
+    std::atomic<uint64_t> m_buckets[ BUCKET_COUNT ];
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max;
+};
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
+
+#endif // AACE_ENGINE_LOCAL_SKILL_SERVICE_LATENCY_HISTOGRAM_H
@@ -0,0 +1,318 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Benchmark of the Local Skill Service request and publish paths. Stands up the service outside of an
+// engine, drives it over its UNIX socket and writes the results as JSON, e.g.
+//
+//     LocalSkillServiceBenchmark --concurrency=1,8,32 --payloads=64,4096 --subscribers=1,10,100,500 --output=lss.json
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <rapidjson/document.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+
+#include "AACE/Engine/LocalSkillService/LocalSkillServiceEngineService.h"
+#include "AACE/Engine/LocalSkillService/LatencyHistogram.h"
+#include "AACE/Engine/LocalSkillService/ToolSupport.h"
+
+using namespace aace::engine::localSkillService;
+using namespace aace::engine::localSkillService::tools;
+
+namespace {
+
+struct Options {
+    std::vector<size_t> concurrency{ 1, 8, 32 };
+    std::vector<size_t> payloads{ 64, 4096 };
+    size_t requests = 20000;
+    std::vector<size_t> subscribers{ 1, 10, 100, 500 };
+    // healthy:slow:dead percentages of the subscribers
+    std::vector<std::vector<size_t>> mixes{ { 100, 0, 0 }, { 80, 20, 0 }, { 80, 10, 10 } };
+    size_t publishes = 10;
+    std::chrono::milliseconds slowDelay{ 50 };
+    std::chrono::milliseconds publishTimeout{ 2000 };
+    std::string output;
+};
+
+std::vector<size_t> parseList( const std::string& value, char separator ) {
+    std::vector<size_t> list;
+    std::stringstream ss( value );
+    std::string item;
+    while ( std::getline( ss, item, separator ) ) {
+        list.push_back( std::strtoull( item.c_str(), nullptr, 10 ) );
+    }
+    return list;
+}
+
+bool parseOptions( int argc, char** argv, Options& options ) {
+    for ( int index = 1; index < argc; index++ ) {
+        std::string arg = argv[index];
+        auto split = arg.find( '=' );
+        if ( arg.compare( 0, 2, "--" ) != 0 || split == std::string::npos ) {
+            return false;
+        }
+        auto name = arg.substr( 2, split - 2 );
+        auto value = arg.substr( split + 1 );
+        if ( name == "concurrency" ) {
+            options.concurrency = parseList( value, ',' );
+        }
+        else if ( name == "payloads" ) {
+            options.payloads = parseList( value, ',' );
+        }
+        else if ( name == "requests" ) {
+            options.requests = std::strtoull( value.c_str(), nullptr, 10 );
+        }
+        else if ( name == "subscribers" ) {
+            options.subscribers = parseList( value, ',' );
+        }
+        else if ( name == "mixes" ) {
+            options.mixes.clear();
+            std::stringstream ss( value );
+            std::string mix;
+            while ( std::getline( ss, mix, ',' ) ) {
+                auto parts = parseList( mix, ':' );
+                if ( parts.size() != 3 ) {
+                    return false;
+                }
+                options.mixes.push_back( parts );
+            }
+        }
+        else if ( name == "publishes" ) {
+            options.publishes = std::strtoull( value.c_str(), nullptr, 10 );
+        }
+        else if ( name == "slow-ms" ) {
+            options.slowDelay = std::chrono::milliseconds( std::strtoll( value.c_str(), nullptr, 10 ) );
+        }
+        else if ( name == "publish-timeout-ms" ) {
+            options.publishTimeout = std::chrono::milliseconds( std::strtoll( value.c_str(), nullptr, 10 ) );
+        }
+        else if ( name == "output" ) {
+            options.output = value;
+        }
+        else {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string makePayload( size_t size ) {
+    // {"data":"xxx..."} padded to the requested size
+    std::string payload = "{\"data\":\"";
+    payload.append( size > 12 ? size - 12 : 0, 'x' );
+    payload += "\"}";
+    return payload;
+}
+
+rapidjson::Value runRequests( const std::string& socketPath, size_t concurrency, size_t payloadSize, size_t total, rapidjson::Document::AllocatorType& allocator ) {
+    LatencyHistogram latency;
+    std::atomic<size_t> next( 0 );
+    std::atomic<size_t> errors( 0 );
+    auto payload = makePayload( payloadSize );
+    std::vector<std::thread> clients;
+    auto start = std::chrono::steady_clock::now();
+    for ( size_t index = 0; index < concurrency; index++ ) {
+        clients.emplace_back( [&] {
+            HttpClient client;
+            if ( !client.connect( socketPath ) ) {
+                errors++;
+                return;
+            }
+            while ( next++ < total ) {
+                auto sent = std::chrono::steady_clock::now();
+                auto status = client.request( "POST", "/echo", payload );
+                latency.record( std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - sent ) );
+                if ( status != 200 ) {
+                    errors++;
+                    // the server closes connections after errors and request limits
+                    if ( status == 0 && !client.connect( socketPath ) ) {
+                        return;
+                    }
+                }
+            }
+        } );
+    }
+    for ( auto& client : clients ) {
+        client.join();
+    }
+    auto seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    rapidjson::Value result( rapidjson::kObjectType );
+    result.AddMember( "concurrency", static_cast<uint64_t>( concurrency ), allocator );
+    result.AddMember( "payloadBytes", static_cast<uint64_t>( payload.size() ), allocator );
+    result.AddMember( "requests", latency.getCount(), allocator );
+    result.AddMember( "errors", static_cast<uint64_t>( errors.load() ), allocator );
+    result.AddMember( "seconds", seconds, allocator );
+    result.AddMember( "requestsPerSecond", seconds > 0 ? latency.getCount() / seconds : 0.0, allocator );
+    result.AddMember( "latencyUs", latency.toJson( allocator ), allocator );
+    return result;
+}
+
+rapidjson::Value runPublishes( std::shared_ptr<LocalSkillServiceEngineService> service, const TopicHandle& topic, const std::string& directory, size_t count, const std::vector<size_t>& mix, const Options& options, rapidjson::Document::AllocatorType& allocator ) {
+    StubSubscribers farm( directory, options.slowDelay );
+    size_t slow = count * mix[1] / 100;
+    size_t dead = count * mix[2] / 100;
+    size_t healthy = count - slow - dead;
+
+    auto subscriptions = std::make_shared<rapidjson::Document>( rapidjson::kArrayType );
+    auto& subscriptionAllocator = subscriptions->GetAllocator();
+    for ( size_t index = 0; index < count; index++ ) {
+        auto kind = index < healthy ? StubSubscribers::Kind::HEALTHY : index < healthy + slow ? StubSubscribers::Kind::SLOW : StubSubscribers::Kind::DEAD;
+        rapidjson::Value item( rapidjson::kObjectType );
+        item.AddMember( "id", rapidjson::Value( topic->getId(), subscriptionAllocator ), subscriptionAllocator );
+        item.AddMember( "endpoint", rapidjson::Value( farm.add( kind ), subscriptionAllocator ), subscriptionAllocator );
+        item.AddMember( "path", "/deliver", subscriptionAllocator );
+        subscriptions->PushBack( item, subscriptionAllocator );
+    }
+    auto copy = [&subscriptions]() {
+        auto document = std::make_shared<rapidjson::Document>();
+        document->CopyFrom( *subscriptions, document->GetAllocator() );
+        return document;
+    };
+    service->invokeHandler( "/subscribe", copy(), std::make_shared<rapidjson::Document>() );
+
+    LatencyHistogram latency;
+    uint64_t delivered = 0;
+    uint64_t failed = 0;
+    uint64_t incomplete = 0;
+    auto start = std::chrono::steady_clock::now();
+    for ( size_t index = 0; index < options.publishes; index++ ) {
+        auto message = std::make_shared<rapidjson::Document>( rapidjson::kObjectType );
+        message->AddMember( "sequence", static_cast<uint64_t>( index ), message->GetAllocator() );
+        auto published = std::chrono::steady_clock::now();
+        auto result = service->publishAndCollect( topic, message, options.publishTimeout ).get();
+        latency.record( std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - published ) );
+        for ( auto& response : result.responses ) {
+            if ( response.status == SubscriberResponse::Status::SUCCESS ) {
+                delivered++;
+            }
+            else {
+                failed++;
+            }
+        }
+        if ( !result.complete ) {
+            incomplete++;
+        }
+    }
+    auto seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    service->invokeHandler( "/unsubscribe", copy(), std::make_shared<rapidjson::Document>() );
+
+    rapidjson::Value result( rapidjson::kObjectType );
+    result.AddMember( "subscribers", static_cast<uint64_t>( count ), allocator );
+    result.AddMember( "healthy", static_cast<uint64_t>( healthy ), allocator );
+    result.AddMember( "slow", static_cast<uint64_t>( slow ), allocator );
+    result.AddMember( "dead", static_cast<uint64_t>( dead ), allocator );
+    result.AddMember( "publishes", latency.getCount(), allocator );
+    result.AddMember( "incompletePublishes", incomplete, allocator );
+    result.AddMember( "delivered", delivered, allocator );
+    // dead subscribers are dropped by the service after their first failed delivery
+    result.AddMember( "failed", failed, allocator );
+    result.AddMember( "seconds", seconds, allocator );
+    result.AddMember( "deliveriesPerSecond", seconds > 0 ? delivered / seconds : 0.0, allocator );
+    result.AddMember( "publishLatencyUs", latency.toJson( allocator ), allocator );
+    return result;
+}
+
+} // namespace
+
+int main( int argc, char** argv ) {
+    Options options;
+    if ( !parseOptions( argc, argv, options ) ) {
+        std::cerr << "usage: " << argv[0] << " [--concurrency=1,8,32] [--payloads=64,4096] [--requests=20000] [--subscribers=1,10,100,500]"
+                  << " [--mixes=100:0:0,80:20:0,80:10:10] [--publishes=10] [--slow-ms=50] [--publish-timeout-ms=2000] [--output=file]" << std::endl;
+        return 2;
+    }
+
+    char directoryTemplate[] = "/tmp/lss-benchmark-XXXXXX";
+    if ( mkdtemp( directoryTemplate ) == nullptr ) {
+        std::cerr << "cannot create socket directory: " << std::strerror( errno ) << std::endl;
+        return 1;
+    }
+    std::string directory = directoryTemplate;
+    std::string socketPath = directory + "/lss.sock";
+
+    auto configuration = std::make_shared<std::stringstream>( "{\"lssSocketPath\":\"" + socketPath + "\"}" );
+    auto service = LocalSkillServiceEngineService::createStandalone( configuration, std::make_shared<MemoryStorage>() );
+    if ( !service ) {
+        std::cerr << "cannot start the service" << std::endl;
+        return 1;
+    }
+    service->registerHandler( "/echo", []( std::shared_ptr<rapidjson::Document> request, std::shared_ptr<rapidjson::Document> response ) -> bool {
+        response->CopyFrom( *request, response->GetAllocator() );
+        return true;
+    } );
+    auto topic = service->registerTopic( "benchmark" );
+
+    rapidjson::Document report( rapidjson::kObjectType );
+    auto& allocator = report.GetAllocator();
+    report.AddMember( "benchmark", "LocalSkillService", allocator );
+    report.AddMember( "timestamp", static_cast<int64_t>( std::chrono::duration_cast<std::chrono::seconds>( std::chrono::system_clock::now().time_since_epoch() ).count() ), allocator );
+
+    rapidjson::Value requests( rapidjson::kArrayType );
+    for ( auto concurrency : options.concurrency ) {
+        for ( auto payload : options.payloads ) {
+            requests.PushBack( runRequests( socketPath, concurrency, payload, options.requests, allocator ), allocator );
+        }
+    }
+    report.AddMember( "requests", requests, allocator );
+
+    rapidjson::Value publishes( rapidjson::kArrayType );
+    for ( auto& mix : options.mixes ) {
+        for ( auto count : options.subscribers ) {
+            publishes.PushBack( runPublishes( service, topic, directory, count, mix, options, allocator ), allocator );
+        }
+    }
+    report.AddMember( "publishes", publishes, allocator );
+
+    // the service's own view of the run
+    auto metrics = service->getMetrics();
+    report.AddMember( "serviceMetrics", rapidjson::Value( *metrics, allocator ), allocator );
+
+    rapidjson::StringBuffer sb;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer( sb );
+    report.Accept( writer );
+    if ( options.output.empty() ) {
+        std::cout << sb.GetString() << std::endl;
+    }
+    else {
+        FILE* file = fopen( options.output.c_str(), "w" );
+        if ( file == nullptr ) {
+            std::cerr << "cannot write " << options.output << std::endl;
+            return 1;
+        }
+        fputs( sb.GetString(), file );
+        fclose( file );
+    }
+
+    // the servers remove their sockets when they stop
+    service.reset();
+    rmdir( directory.c_str() );
+    return 0;
+}
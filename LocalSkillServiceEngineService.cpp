@@ -13,9 +13,17 @@
  * permissions and limitations under the License.
  */
  
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <sstream>
 #include <thread>
 
+#include <unistd.h>
+
 #include <rapidjson/error/en.h>
 #include <rapidjson/istreamwrapper.h>
 #include <rapidjson/pointer.h>
@@ -23,6 +31,12 @@
 #include <curl/curl.h>
 
 #include "AACE/Engine/LocalSkillService/LocalSkillServiceEngineService.h"
+#include "AACE/Engine/LocalSkillService/DocumentPool.h"
+#include "AACE/Engine/LocalSkillService/RecyclingPool.h"
+#include "AACE/Engine/LocalSkillService/EndpointProber.h"
+#include "AACE/Engine/LocalSkillService/SubscriptionReader.h"
+#include "AACE/Engine/LocalSkillService/AsyncLogger.h"
+#include "AACE/Engine/LocalSkillService/TraceRecorder.h"
 #include "AACE/Engine/Core/EngineMacros.h"
 
 namespace aace {
@@ -35,9 +49,252 @@ static const std::string TAG("aace.localSkillService.LocalSkillServiceEngineServ
 // name of the table used for the local storage database
 static const std::string LOCAL_SKILL_SERVICE_LOCAL_STORAGE_TABLE = "aace.localSkillService";
 
+// upper bound for a single delivery to a subscriber
+static const std::chrono::milliseconds PUBLISH_TIMEOUT( 20000 );
+
+// number of workers used for request/reply deliveries
+static const size_t REQUEST_WORKER_COUNT = 4;
+
+// capacity of the executor queues
+static const size_t HANDLER_QUEUE_CAPACITY = 1024;
+static const size_t PUBLISH_QUEUE_CAPACITY = 64;
+static const size_t REQUEST_QUEUE_CAPACITY = 1024;
+static const size_t LOCAL_QUEUE_CAPACITY = 1024;
+
+// a hedged request is sent once the primary exceeds this percentile of its recent latencies
+static const double HEDGE_LATENCY_PERCENTILE = 95.0;
+
+// latency assumed for subscribers without recorded samples
+static const std::chrono::milliseconds DEFAULT_SUBSCRIBER_LATENCY( 100 );
+
+// number of recent latencies kept per subscriber
+static const size_t SUBSCRIBER_LATENCY_SAMPLES = 32;
+
+// request header carrying the caller's timeout in milliseconds
+static const std::string REQUEST_TIMEOUT_HEADER = "X-Request-Timeout";
+
+// upper bound on the number of requests in a single /batch call
+static const size_t MAX_BATCH_SIZE = 64;
+
+// persisted subscriptions are added to the registry this many at a time, releasing the lock in between
+static const size_t SUBSCRIPTION_LOAD_BATCH = 256;
+
+// defaults for lssProbeInterval and lssProbeGracePeriod: a skill has this long after start() to begin listening
+static const std::chrono::milliseconds DEFAULT_PROBE_INTERVAL( 1000 );
+static const std::chrono::milliseconds DEFAULT_PROBE_GRACE_PERIOD( 30000 );
+
+// a connect to a local socket that is still in progress after this long counts as not listening
+static const std::chrono::milliseconds PROBE_CONNECT_TIMEOUT( 200 );
+
+// socket activation passes listening sockets from this descriptor on, named in LISTEN_FDNAMES
+static const int LISTEN_FDS_START = 3;
+static const std::string DEFAULT_SOCKET_NAME = "lss";
+
+// a delivery worker releases its serialized request buffer after a delivery larger than this
+static const size_t MAX_RETAINED_DELIVERY_BUFFER = 64 * 1024;
+
+#ifdef LSS_TRACING
+// one in this many requests and publishes is traced unless lssTraceSampleRate says otherwise
+static const uint32_t DEFAULT_TRACE_SAMPLE_RATE = 100;
+#endif
+
 // register the service
 REGISTER_SERVICE(LocalSkillServiceEngineService);
 
+// response statuses with their own latency histogram per route; anything else shares the last slot
+static const int ROUTE_STATUS_CODES[] = { 200, 204, 500, 503, 504 };
+
+// returns the status that was sent
+static int sendResponse( const std::shared_ptr<HttpRequest>& httpRequest, bool success, const std::shared_ptr<rapidjson::Document>& response, uint64_t traceId ) {
+    // only read by the trace macros
+    (void)traceId;
+    try {
+        auto& path = httpRequest->getPath();
+        if ( success ) {
+            if ( response->IsObject() || response->IsArray() ) {
+                rapidjson::StringBuffer sb;
+                {
+                    LSS_TRACE_SCOPE( traceId, "serialize", "request" );
+                    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+                    response->Accept( writer );
+                }
+                LSS_VERBOSE( TAG.c_str(), "sendResponse", "request", path, "status", 200 );
+                LSS_TRACE_SCOPE( traceId, "respond", "request" );
+                httpRequest->respond( 200, sb.GetString() );
+                return 200;
+            }
+            else {
+                LSS_VERBOSE( TAG.c_str(), "sendResponse", "request", path, "status", 204 );
+                httpRequest->respond( 204, "" );
+                return 204;
+            }
+        }
+        else {
+            LSS_VERBOSE( TAG.c_str(), "sendResponse", "request", path, "status", 500 );
+            httpRequest->respond( 500, "" );
+            return 500;
+        }
+    }
+    catch( std::exception& ex ) {
+        AACE_ERROR(LX(TAG).m("sendResponse").d("reason", ex.what()));
+        return 500;
+    }
+}
+
+static std::chrono::microseconds elapsedSince( std::chrono::steady_clock::time_point start ) {
+    return std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start );
+}
+
+// returns start + timeout, saturating at time_point::max() instead of overflowing for very long timeouts
+static std::chrono::steady_clock::time_point deadlineAfter( std::chrono::steady_clock::time_point start, std::chrono::milliseconds timeout ) {
+    if ( timeout.count() <= 0 ) {
+        return start;
+    }
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::time_point::max() - start );
+    if ( timeout >= remaining ) {
+        return std::chrono::steady_clock::time_point::max();
+    }
+    return start + timeout;
+}
+
+static std::string getSubscriptionKey( const std::string& id, const std::string& endpoint, const std::string& path ) {
+    return id + '\n' + endpoint + '\n' + path;
+}
+
+// returns the socket called @c name that systemd style socket activation passed to this process, or -1
+static int getActivatedSocket( const std::string& name ) {
+    const char* pid = std::getenv( "LISTEN_PID" );
+    const char* fds = std::getenv( "LISTEN_FDS" );
+    if ( pid == nullptr || fds == nullptr || std::strtol( pid, nullptr, 10 ) != getpid() ) {
+        return -1;
+    }
+    long count = std::strtol( fds, nullptr, 10 );
+    const char* names = std::getenv( "LISTEN_FDNAMES" );
+    if ( names == nullptr ) {
+        // without names only a single socket is unambiguous
+        return count == 1 ? LISTEN_FDS_START : -1;
+    }
+    std::stringstream stream( names );
+    std::string item;
+    for ( long index = 0; index < count && std::getline( stream, item, ':' ); index++ ) {
+        if ( item == name ) {
+            return LISTEN_FDS_START + static_cast<int>( index );
+        }
+    }
+    return -1;
+}
+
+static const char* getLivenessName( Subscriber::Liveness liveness ) {
+    switch ( liveness ) {
+        case Subscriber::Liveness::LIVE:
+            return "LIVE";
+        case Subscriber::Liveness::PENDING:
+            return "PENDING";
+        case Subscriber::Liveness::DEAD:
+            return "DEAD";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+static void removeUnreachable( std::vector<std::shared_ptr<Subscriber>>& subscribers ) {
+    subscribers.erase( std::remove_if( subscribers.begin(), subscribers.end(), []( const std::shared_ptr<Subscriber>& subscriber ) {
+        return !subscriber->isReachable();
+    } ), subscribers.end() );
+}
+
+// completion of a request received over HTTP, holding what answering it needs, so it takes a single pooled allocation
+struct HttpCompletion {
+    HttpCompletion( std::shared_ptr<rapidjson::Document> response, std::shared_ptr<HttpRequest> httpRequest, std::shared_ptr<LocalSkillServiceEngineService::RouteMetrics> metrics, std::chrono::steady_clock::time_point received, std::chrono::steady_clock::time_point deadline, uint64_t traceId ) :
+        httpRequest( std::move( httpRequest ) ),
+        metrics( std::move( metrics ) ),
+        received( received ),
+        traceId( traceId ),
+        completion( std::move( response ), respond, this, deadline, this->httpRequest->getCancellationToken() ) {
+    }
+
+    // answered from whichever thread completes the request
+    static void respond( void* context, bool success, const std::shared_ptr<rapidjson::Document>& response ) {
+        auto self = static_cast<HttpCompletion*>( context );
+        auto status = sendResponse( self->httpRequest, success, response, self->traceId );
+        self->metrics->total[ LocalSkillServiceEngineService::getStatusSlot( status ) ].record( elapsedSince( self->received ) );
+        LSS_TRACE_SPAN( self->traceId, "request", "request", self->received, std::chrono::steady_clock::now(), self->httpRequest->getPath() );
+    }
+
+    std::shared_ptr<HttpRequest> httpRequest;
+    std::shared_ptr<LocalSkillServiceEngineService::RouteMetrics> metrics;
+    std::chrono::steady_clock::time_point received;
+    uint64_t traceId;
+    // declared last, so the members above are still alive when it fails a dropped request from its destructor
+    RequestCompletion completion;
+};
+
+// starts a request handler on the handler executor; the members are moved in, so queuing copies nothing
+struct HandlerTask {
+    std::shared_ptr<const LocalSkillServiceEngineService::AsyncRequestHandler> handler;
+    std::shared_ptr<rapidjson::Document> request;
+    std::shared_ptr<rapidjson::Document> response;
+    std::shared_ptr<HttpRequest> httpRequest;
+    std::chrono::steady_clock::time_point deadline;
+    std::shared_ptr<LocalSkillServiceEngineService::RouteMetrics> metrics;
+    std::chrono::steady_clock::time_point received;
+    uint64_t traceId;
+
+    void operator()() {
+        auto started = std::chrono::steady_clock::now();
+        metrics->queueWait.record( std::chrono::duration_cast<std::chrono::microseconds>( started - received ) );
+        LSS_TRACE_SPAN( traceId, "queueWait", "request", received, started );
+        // work nobody is waiting for any more is dropped before it starts
+        if ( httpRequest->isCancelled() ) {
+            LSS_VERBOSE( TAG.c_str(), "dropping", "request", httpRequest->getPath(), "reason", "clientDisconnected" );
+            return;
+        }
+        if ( started >= deadline ) {
+            LSS_WARN( TAG.c_str(), "dropping", "request", httpRequest->getPath(), "status", 504, "reason", "deadlineExpired" );
+            httpRequest->respond( 504, "" );
+            metrics->total[ LocalSkillServiceEngineService::getStatusSlot( 504 ) ].record( elapsedSince( received ) );
+            return;
+        }
+        auto state = std::allocate_shared<HttpCompletion>( PoolAllocator<HttpCompletion>(), std::move( response ), httpRequest, metrics, received, deadline, traceId );
+        std::shared_ptr<RequestCompletion> completion( state, &state->completion );
+        try {
+            LSS_TRACE_SCOPE( traceId, "handler", "request" );
+            ( *handler )( std::move( request ), completion );
+        }
+        catch( std::exception& ex ) {
+            AACE_ERROR(LX(TAG).m("executor").d("reason", ex.what()));
+            completion->complete( false );
+        }
+        metrics->run.record( elapsedSince( started ) );
+    }
+};
+
+#ifdef LSS_TRACING
+// splits a finished transfer into spans using the phase times measured by curl
+static void traceTransfer( uint64_t traceId, CURL* curl, std::chrono::steady_clock::time_point started ) {
+    double connect = 0, pretransfer = 0, starttransfer = 0, total = 0;
+    curl_easy_getinfo( curl, CURLINFO_CONNECT_TIME, &connect );
+    curl_easy_getinfo( curl, CURLINFO_PRETRANSFER_TIME, &pretransfer );
+    curl_easy_getinfo( curl, CURLINFO_STARTTRANSFER_TIME, &starttransfer );
+    curl_easy_getinfo( curl, CURLINFO_TOTAL_TIME, &total );
+    auto at = [started]( double seconds ) {
+        return started + std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double>( seconds ) );
+    };
+    LSS_TRACE_SPAN( traceId, "connect", "delivery", started, at( connect ) );
+    if ( starttransfer > 0 ) {
+        // sending the request and waiting for the first byte of the response
+        LSS_TRACE_SPAN( traceId, "send", "delivery", at( pretransfer ), at( starttransfer ) );
+        LSS_TRACE_SPAN( traceId, "receive", "delivery", at( starttransfer ), at( total ) );
+    }
+}
+#endif
+
+// aborts a transfer once the result it contributes to has been resolved
+static int curlCancelCallback( void* clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t ) {
+    auto done = static_cast<std::atomic<bool>*>( clientp );
+    return done != nullptr && done->load() ? 1 : 0;
+}
+
 static size_t curlWriteCallback( char* ptr, size_t size, size_t nmemb, void* userdata ) {
     try {
         size_t result = 0;
@@ -54,17 +311,97 @@ static size_t curlWriteCallback( char* ptr, size_t size, size_t nmemb, void* use
     }
 }
 
-LocalSkillServiceEngineService::LocalSkillServiceEngineService( const aace::engine::core::ServiceDescription& description ) : aace::engine::core::EngineService( description ), m_server( nullptr ) {
+// curl handle and buffers kept by each delivery worker, so a delivery does not allocate them
+struct DeliveryContext {
+    DeliveryContext() : curl( nullptr ) {
+    }
+
+    ~DeliveryContext() {
+        if ( curl != nullptr ) {
+            curl_easy_cleanup( curl );
+        }
+    }
+
+    // resetting keeps the handle's connection and DNS caches
+    CURL* acquireHandle() {
+        if ( curl == nullptr ) {
+            curl = curl_easy_init();
+        }
+        else {
+            curl_easy_reset( curl );
+        }
+        return curl;
+    }
+
+    CURL* curl;
+    std::string url;
+    rapidjson::StringBuffer request;
+};
+
+static void releaseDeliveryContext( DeliveryContext* context ) {
+    if ( context->request.GetSize() > MAX_RETAINED_DELIVERY_BUFFER ) {
+        context->request.Clear();
+        context->request.ShrinkToFit();
+    }
+    else {
+        context->request.Clear();
+    }
+}
+
+static DeliveryContext* acquireDeliveryContext() {
+    static thread_local DeliveryContext context;
+    return &context;
+}
+
+LocalSkillServiceEngineService::LocalSkillServiceEngineService( const aace::engine::core::ServiceDescription& description ) : aace::engine::core::EngineService( description ), m_server( nullptr ),
+    m_subscriptionsLoaded( false ),
+    m_subscriptionsDirty( false ),
+    m_probeInterval( DEFAULT_PROBE_INTERVAL ),
+    m_probeGracePeriod( DEFAULT_PROBE_GRACE_PERIOD ),
+    m_startupStopping( false ),
+    m_publishSequence( 0 ),
+    m_publishDrainScheduled( false ),
+    m_handlerExecutor( 1, HANDLER_QUEUE_CAPACITY ),
+    m_publishExecutor( 1, PUBLISH_QUEUE_CAPACITY ),
+    m_requestExecutor( REQUEST_WORKER_COUNT, REQUEST_QUEUE_CAPACITY ),
+    m_localExecutor( 1, LOCAL_QUEUE_CAPACITY ) {
+}
+
+LocalSkillServiceEngineService::~LocalSkillServiceEngineService() {
+    stopStartupThread();
+    // timers and handlers dispatch onto the executors, so stop them before any member is destroyed
+    m_timerQueue.shutdown();
+    m_handlerExecutor.shutdown();
+    m_publishExecutor.shutdown();
+    m_requestExecutor.shutdown();
+    m_localExecutor.shutdown();
 }
 
-LocalSkillServiceEngineService::~LocalSkillServiceEngineService() = default;
+std::shared_ptr<LocalSkillServiceEngineService> LocalSkillServiceEngineService::createStandalone( std::shared_ptr<std::istream> configuration, std::shared_ptr<aace::engine::storage::LocalStorageInterface> localStorage ) {
+    try {
+        ThrowIfNull( localStorage, "invalidLocalStorage" );
+        auto service = std::shared_ptr<LocalSkillServiceEngineService>( new LocalSkillServiceEngineService( *getServiceDescription() ), []( LocalSkillServiceEngineService* service ) {
+            service->stop();
+            delete service;
+        } );
+        service->m_localStorage = localStorage;
+        ThrowIfNot( service->configure( configuration ), "configureFailed" );
+        ThrowIfNot( service->start(), "startFailed" );
+        return service;
+    }
+    catch( std::exception& ex ) {
+        AACE_ERROR(LX(TAG).d("reason", ex.what()));
+        return nullptr;
+    }
+}
 
 bool LocalSkillServiceEngineService::configure( std::shared_ptr<std::istream> configuration )
 {
     try
     {
         bool handled = false;
-        uint32_t timeoutMs = 100;
+        // the server loop is readiness driven, so by default it never wakes up just to poll
+        int pollTimeoutMs = -1;
 
         ThrowIfNotNull( m_server, "HTTPServer already created" );
         rapidjson::IStreamWrapper isw( *configuration );
@@ -75,14 +412,109 @@ bool LocalSkillServiceEngineService::configure( std::shared_ptr<std::istream> co
         ThrowIf( document.HasParseError(), GetParseError_En( document.GetParseError() ) );
         ThrowIfNot( document.IsObject(), "invalidConfigurationStream" );
 
+        rapidjson::Value* pollTimeout = GetValueByPointer( document, "/lssServerPollTimeout" );
+        if ( pollTimeout && pollTimeout->IsInt() ) {
+            pollTimeoutMs = pollTimeout->GetInt();
+        }
+
+        // a listening socket inherited from the launcher is used instead of binding lssSocketPath, so skills
+        // can connect before the engine is up: either the descriptor in lssSocketFd, or with socket activation
+        // the one called lssSocketName
+        int listenFd = -1;
+        rapidjson::Value* socketFd = GetValueByPointer( document, "/lssSocketFd" );
+        rapidjson::Value* socketName = GetValueByPointer( document, "/lssSocketName" );
         rapidjson::Value* serverEndpoint = GetValueByPointer( document, "/lssSocketPath" );
-        if ( serverEndpoint && serverEndpoint->IsString() ) {
-            m_server = HttpServer::create( serverEndpoint->GetString(), timeoutMs );
+        if ( socketFd && socketFd->IsInt() ) {
+            listenFd = socketFd->GetInt();
+        }
+        else if ( socketName && socketName->IsString() ) {
+            listenFd = getActivatedSocket( socketName->GetString() );
+        }
+        else if ( serverEndpoint ) {
+            listenFd = getActivatedSocket( DEFAULT_SOCKET_NAME );
+        }
+        if ( listenFd >= 0 ) {
+            m_server = HttpServer::createFromListenFd( listenFd, pollTimeoutMs );
+            handled = true;
+        }
+
+        if ( !m_server && serverEndpoint && serverEndpoint->IsString() ) {
+            m_server = HttpServer::create( serverEndpoint->GetString(), pollTimeoutMs );
             handled = true;
         }
 
         ThrowIfNull( m_server, "cannot create HTTPServer" );
 
+        rapidjson::Value* idleTimeout = GetValueByPointer( document, "/lssServerIdleTimeout" );
+        if ( idleTimeout && idleTimeout->IsUint() ) {
+            m_server->setIdleTimeout( std::chrono::milliseconds( idleTimeout->GetUint() ) );
+        }
+        rapidjson::Value* maxRequests = GetValueByPointer( document, "/lssServerMaxRequestsPerConnection" );
+        if ( maxRequests && maxRequests->IsUint() ) {
+            m_server->setMaxRequestsPerConnection( maxRequests->GetUint() );
+        }
+
+        // wait and hold times of the service locks are only recorded on request
+        rapidjson::Value* lockMetrics = GetValueByPointer( document, "/lssLockMetrics" );
+        if ( lockMetrics && lockMetrics->IsBool() ) {
+            m_handlerMutex.setEnabled( lockMetrics->GetBool() );
+            m_subscriptionMutex.setEnabled( lockMetrics->GetBool() );
+        }
+
+        // request and delivery paths log through the asynchronous logger, which defaults to warnings
+        rapidjson::Value* logLevel = GetValueByPointer( document, "/lssLogLevel" );
+        if ( logLevel && logLevel->IsString() ) {
+            std::string level = logLevel->GetString();
+            if ( level == "VERBOSE" ) {
+                AsyncLogger::setLevel( AsyncLogger::Level::VERBOSE );
+            }
+            else if ( level == "INFO" ) {
+                AsyncLogger::setLevel( AsyncLogger::Level::INFO );
+            }
+            else if ( level == "WARN" ) {
+                AsyncLogger::setLevel( AsyncLogger::Level::WARN );
+            }
+            else if ( level == "ERROR" ) {
+                AsyncLogger::setLevel( AsyncLogger::Level::ERROR );
+            }
+            else if ( level == "NONE" ) {
+                AsyncLogger::setLevel( AsyncLogger::Level::NONE );
+            }
+            else {
+                AACE_WARN(LX(TAG).d("lssLogLevel", level).m("unknownLogLevel"));
+            }
+        }
+
+        // persisted endpoints not listening at start() are probed every lssProbeInterval ms for lssProbeGracePeriod ms
+        rapidjson::Value* probeInterval = GetValueByPointer( document, "/lssProbeInterval" );
+        if ( probeInterval && probeInterval->IsUint() && probeInterval->GetUint() > 0 ) {
+            m_probeInterval = std::chrono::milliseconds( probeInterval->GetUint() );
+        }
+        rapidjson::Value* probeGracePeriod = GetValueByPointer( document, "/lssProbeGracePeriod" );
+        if ( probeGracePeriod && probeGracePeriod->IsUint() ) {
+            m_probeGracePeriod = std::chrono::milliseconds( probeGracePeriod->GetUint() );
+        }
+
+        // requests and publishes are written to lssCaptureFile for replay; bodies and payloads are stored in
+        // plaintext and may contain user data, so enable it only for debugging
+        rapidjson::Value* captureFile = GetValueByPointer( document, "/lssCaptureFile" );
+        if ( captureFile && captureFile->IsString() ) {
+            m_capture.open( captureFile->GetString() );
+        }
+
+#ifdef LSS_TRACING
+        // spans of one in every lssTraceSampleRate requests and publishes are written to lssTraceFile
+        rapidjson::Value* traceFile = GetValueByPointer( document, "/lssTraceFile" );
+        if ( traceFile && traceFile->IsString() ) {
+            uint32_t sampleRate = DEFAULT_TRACE_SAMPLE_RATE;
+            rapidjson::Value* traceSampleRate = GetValueByPointer( document, "/lssTraceSampleRate" );
+            if ( traceSampleRate && traceSampleRate->IsUint() && traceSampleRate->GetUint() > 0 ) {
+                sampleRate = traceSampleRate->GetUint();
+            }
+            TraceRecorder::getInstance().open( traceFile->GetString(), sampleRate );
+        }
+#endif
+
         m_server->setRequestHandler([this]( std::shared_ptr<engine::localSkillService::HttpRequest> request ) {
             return handleRequest( request );
         });
@@ -97,12 +529,26 @@ bool LocalSkillServiceEngineService::configure( std::shared_ptr<std::istream> co
                 return unsubscribeHandler( request, response );
             }
         );
+        registerHandler("/metrics",
+            [this]( std::shared_ptr<rapidjson::Document>, std::shared_ptr<rapidjson::Document> response ) -> bool {
+                buildMetrics( *response );
+                return true;
+            }
+        );
+        registerAsyncHandler("/batch",
+            [this]( std::shared_ptr<rapidjson::Document> request, std::shared_ptr<RequestCompletion> completion ) {
+                batchHandler( request, completion );
+            }
+        );
 
-        ThrowIfNot( registerServiceInterface<LocalSkillServiceEngineService>( shared_from_this() ), "registerLocalSkillServiceFailed" );
+        // a standalone service brings its own storage and is not part of an engine
+        if ( !m_localStorage ) {
+            ThrowIfNot( registerServiceInterface<LocalSkillServiceEngineService>( shared_from_this() ), "registerLocalSkillServiceFailed" );
 
-        // get the local storage instance
-        m_localStorage = getContext()->getServiceInterface<aace::engine::storage::LocalStorageInterface>( "aace.storage" );
-        ThrowIfNull( m_localStorage, "invalidLocalStorage" );
+            // get the local storage instance
+            m_localStorage = getContext()->getServiceInterface<aace::engine::storage::LocalStorageInterface>( "aace.storage" );
+            ThrowIfNull( m_localStorage, "invalidLocalStorage" );
+        }
 
         return handled;
     }
@@ -116,337 +562,1258 @@ bool LocalSkillServiceEngineService::configure( std::shared_ptr<std::istream> co
 
 bool LocalSkillServiceEngineService::start() {
     if ( !m_server ) return false;
-    readSubscriptions();
-    m_server->start();
-    return true;
+    // the server accepts requests while the persisted subscriptions load; publishes reach the ones loaded so far
+    if ( !m_startupThread.joinable() ) {
+        m_startupStopping = false;
+        m_startupThread = std::thread( [this]() {
+            readSubscriptions();
+            probeSubscribers();
+        } );
+    }
+    return m_server->start();
 }
 
 bool LocalSkillServiceEngineService::stop() {
     if ( !m_server ) return false;
     m_server->stop();
+    stopStartupThread();
+    m_capture.close();
+#ifdef LSS_TRACING
+    TraceRecorder::getInstance().close();
+#endif
     return true;
 }
 
-void LocalSkillServiceEngineService::registerHandler( const std::string& path, RequestHandler handler ) {
-    std::lock_guard<std::mutex> guard( m_handlerMutex );
+void LocalSkillServiceEngineService::registerHandler( const std::string& path, RequestHandler handler, std::chrono::milliseconds timeout ) {
+    // synchronous handlers complete as soon as they return
+    registerAsyncHandler( path, [handler]( std::shared_ptr<rapidjson::Document> request, std::shared_ptr<RequestCompletion> completion ) {
+        completion->complete( handler( request, completion->getResponse() ) );
+    }, timeout );
+}
+
+void LocalSkillServiceEngineService::registerAsyncHandler( const std::string& path, AsyncRequestHandler handler, std::chrono::milliseconds timeout ) {
+    InstrumentedLock guard( m_handlerMutex, "registerAsyncHandler" );
     if ( m_requestHandlers.find( path ) != m_requestHandlers.end() ) {
         AACE_DEBUG(LX( TAG ).d( "replacing handler", path ));
     }
-    m_requestHandlers[ path ] = handler;
+    // replacing a handler keeps the metrics collected for the route so far
+    auto& route = m_requestHandlers[ path ];
+    route.handler = std::make_shared<const AsyncRequestHandler>( std::move( handler ) );
+    route.timeout = timeout;
+    if ( !route.metrics ) {
+        route.metrics = std::make_shared<RouteMetrics>();
+    }
 }
 
-bool LocalSkillServiceEngineService::registerPublishHandler( const std::string& id, RequestHandler subscribeHandler, PublishRequestHandler requestHandler, PublishResponseHandler responseHandler ) {
+bool LocalSkillServiceEngineService::invokeHandler( const std::string& path, std::shared_ptr<rapidjson::Document> request, std::shared_ptr<rapidjson::Document> response ) {
     try {
-        std::lock_guard<std::mutex> guard( m_subscriptionMutex );
-        if ( subscribeHandler ) {
-            m_subscribeHandlers[ id ] = subscribeHandler;
+        std::shared_ptr<const AsyncRequestHandler> handler;
+        std::chrono::milliseconds timeout{ 0 };
+        {
+            InstrumentedLock guard( m_handlerMutex, "invokeHandler" );
+            auto it = m_requestHandlers.find( path );
+            ThrowIf( it == m_requestHandlers.end(), "handlerNotFound" );
+            handler = it->second.handler;
+            timeout = it->second.timeout;
         }
-        if ( requestHandler ) {
-            m_publishRequestHandlers[ id ] = requestHandler;
+        // the route timeout applies to in-process callers as it does to HTTP requests
+        auto deadline = timeout.count() > 0 ? deadlineAfter( std::chrono::steady_clock::now(), timeout ) : std::chrono::steady_clock::time_point::max();
+        auto promise = std::make_shared<std::promise<bool>>();
+        auto result = promise->get_future();
+        ( *handler )( request, std::make_shared<RequestCompletion>( response, [promise]( bool success, std::shared_ptr<rapidjson::Document> ) {
+            promise->set_value( success );
+        }, deadline ) );
+        if ( deadline != std::chrono::steady_clock::time_point::max() ) {
+            ThrowIf( result.wait_until( deadline ) != std::future_status::ready, "handlerTimedOut" );
         }
-        if ( responseHandler ) {
-            m_publishResponseHandlers[ id ] = responseHandler;
+        return result.get();
+    }
+    catch( std::exception& ex ) {
+        AACE_ERROR(LX(TAG).d("path", path).d("reason", ex.what()));
+        return false;
+    }
+}
+
+bool LocalSkillServiceEngineService::subscribeLocal( const std::string& id, const std::string& name, Subscriber::LocalHandler handler ) {
+    try {
+        ThrowIfNull( handler, "invalidHandler" );
+        auto topic = getTopic( id );
+        ThrowIfNull( topic, "subscriptionNotFound" );
+        auto subscriber = std::make_shared<Subscriber>( name, handler );
+        ThrowIfNot( addSubscription( topic, subscriber ), "addSubscriptionFailed" );
+        // same as a remote subscribe, without a caller to return the subscribe handler result to
+        RequestHandler subscribeHandler = nullptr;
+        {
+            std::lock_guard<std::mutex> guardTopic( topic->m_mutex );
+            subscribeHandler = topic->m_subscribeHandler;
+        }
+        if ( subscribeHandler ) {
+            ThrowIfNot( subscribeHandler( nullptr, DocumentPool::acquire() ), "subscribeHandlerFailed" );
         }
-        if ( m_subscriptions.find( id ) == m_subscriptions.end() ) {
-            m_subscriptions[ id ] = std::make_shared<Subscriptions>();
+        auto task = createPublishTask( topic, subscriber );
+        if ( task->requestHandler || task->responseHandler ) {
+            schedulePublishTask( task );
         }
         return true;
     }
     catch( std::exception& ex ) {
-        AACE_ERROR(LX(TAG).d("reason", ex.what()));
+        AACE_ERROR(LX(TAG).d("id", id).d("name", name).d("reason", ex.what()));
         return false;
     }
 }
 
-bool LocalSkillServiceEngineService::publishMessage( const std::string& id, std::shared_ptr<rapidjson::Document> message ) {
+bool LocalSkillServiceEngineService::unsubscribeLocal( const std::string& id, const std::string& name ) {
+    auto topic = getTopic( id );
+    if ( !topic ) {
+        AACE_ERROR(LX(TAG).d("id", id).d("name", name).d("reason", "subscriptionNotFound"));
+        return false;
+    }
+    // local subscribers compare by name only
+    auto subscriber = std::make_shared<Subscriber>( name, []( std::shared_ptr<const rapidjson::Document>, std::shared_ptr<rapidjson::Document> ) {
+        return true;
+    } );
+    return removeSubscription( topic, subscriber );
+}
+
+TopicHandle LocalSkillServiceEngineService::registerTopic( const std::string& id, RequestHandler subscribeHandler, PublishRequestHandler requestHandler, PublishResponseHandler responseHandler ) {
     try {
-        std::lock_guard<std::mutex> guard( m_subscriptionMutex );
-        ThrowIf( m_subscriptions.find( id ) == m_subscriptions.end(), "subscriptionNotFound");
-        PublishRequestHandler requestHandler = nullptr;
-        PublishResponseHandler responseHandler = nullptr;
-        if ( m_publishRequestHandlers.find( id ) != m_publishRequestHandlers.end() ) {
-           requestHandler = m_publishRequestHandlers[id];
+        InstrumentedLock guard( m_subscriptionMutex, "registerTopic" );
+        auto& topic = m_topics[ id ];
+        if ( !topic ) {
+            topic = std::make_shared<Topic>( id );
         }
-        if ( m_publishResponseHandlers.find( id ) != m_publishResponseHandlers.end() ) {
-           responseHandler = m_publishResponseHandlers[id];
+        std::lock_guard<std::mutex> guardTopic( topic->m_mutex );
+        if ( subscribeHandler ) {
+            topic->m_subscribeHandler = subscribeHandler;
         }
-        auto subscribers = m_subscriptions[ id ]->getSubscribers();
-        for ( auto& subscriber : subscribers ) {
-            m_publishExecutor.submit( [this, id, subscriber, message, requestHandler, responseHandler] {
-                publishMessageToSubscriber( id, subscriber, message, requestHandler, responseHandler );
-            } );
+        if ( requestHandler ) {
+            topic->m_requestHandler = requestHandler;
         }
-        return true;
+        if ( responseHandler ) {
+            topic->m_responseHandler = responseHandler;
+        }
+        return topic;
     }
     catch( std::exception& ex ) {
-        AACE_ERROR(LX(TAG).d("reason", ex.what()));
+        AACE_ERROR(LX(TAG).d("id", id).d("reason", ex.what()));
+        return nullptr;
+    }
+}
+
+TopicHandle LocalSkillServiceEngineService::getTopic( const std::string& id ) {
+    InstrumentedLock guard( m_subscriptionMutex, "getTopic" );
+    auto it = m_topics.find( id );
+    return it != m_topics.end() ? it->second : nullptr;
+}
+
+bool LocalSkillServiceEngineService::registerPublishHandler( const std::string& id, RequestHandler subscribeHandler, PublishRequestHandler requestHandler, PublishResponseHandler responseHandler ) {
+    return registerTopic( id, subscribeHandler, requestHandler, responseHandler ) != nullptr;
+}
+
+bool LocalSkillServiceEngineService::publishMessage( const std::string& id, std::shared_ptr<rapidjson::Document> message ) {
+    return publish( getTopic( id ), message, nullptr, std::chrono::steady_clock::time_point::max() );
+}
+
+bool LocalSkillServiceEngineService::publishMessage( const std::string& id, std::nullptr_t ) {
+    return publish( getTopic( id ), nullptr, nullptr, std::chrono::steady_clock::time_point::max() );
+}
+
+bool LocalSkillServiceEngineService::publishMessage( const std::string& id, std::shared_ptr<rapidjson::Document> message, std::chrono::milliseconds ttl ) {
+    return publish( getTopic( id ), message, nullptr, deadlineAfter( std::chrono::steady_clock::now(), ttl ) );
+}
+
+bool LocalSkillServiceEngineService::publishMessage( const std::string& id, std::shared_ptr<rapidjson::Document> message, std::chrono::steady_clock::time_point deadline ) {
+    return publish( getTopic( id ), message, nullptr, deadline );
+}
+
+bool LocalSkillServiceEngineService::publishMessage( const std::string& id, std::shared_ptr<const std::string> payload, std::chrono::steady_clock::time_point deadline ) {
+    if ( !payload ) {
+        AACE_ERROR(LX(TAG).d("id", id).d("reason", "invalidPayload"));
         return false;
     }
+    return publish( getTopic( id ), nullptr, payload, deadline );
 }
 
-void LocalSkillServiceEngineService::handleRequest( std::shared_ptr<engine::localSkillService::HttpRequest> request ) {
-    try {
-        std::lock_guard<std::mutex> guard( m_handlerMutex );
-        
-        // prepare request
-        auto path = request->getPath();
-        auto method = request->getMethod();
-        AACE_DEBUG(LX(TAG).d("request", path).d("method", method));
-        std::shared_ptr<rapidjson::Document> jsonRequest = nullptr;
-		AACE_ERROR(LX(TAG).d("reason", request->getBody().c_str()));
-        if ( method == "POST" ) {
-            auto payload = request->getBody();
-            jsonRequest = std::make_shared<rapidjson::Document>();
-            if ( !payload.empty() && jsonRequest->Parse( payload.c_str() ).HasParseError() ) {
-                request->respond( 400, "" );
-                return;
+bool LocalSkillServiceEngineService::publishMessage( const std::string& id, std::shared_ptr<const std::string> payload, std::chrono::milliseconds ttl ) {
+    return publishMessage( id, payload, deadlineAfter( std::chrono::steady_clock::now(), ttl ) );
+}
+
+bool LocalSkillServiceEngineService::publishMessage( const TopicHandle& topic, std::shared_ptr<rapidjson::Document> message, std::chrono::steady_clock::time_point deadline ) {
+    return publish( topic, message, nullptr, deadline );
+}
+
+bool LocalSkillServiceEngineService::publishMessage( const TopicHandle& topic, std::nullptr_t ) {
+    return publish( topic, nullptr, nullptr, std::chrono::steady_clock::time_point::max() );
+}
+
+bool LocalSkillServiceEngineService::publishMessage( const TopicHandle& topic, std::shared_ptr<const std::string> payload, std::chrono::steady_clock::time_point deadline ) {
+    if ( !payload ) {
+        AACE_ERROR(LX(TAG).d("reason", "invalidPayload"));
+        return false;
+    }
+    return publish( topic, nullptr, payload, deadline );
+}
+
+std::future<PublishResult> LocalSkillServiceEngineService::publishAndCollect( const std::string& id, std::shared_ptr<rapidjson::Document> message, std::chrono::milliseconds timeout, size_t firstN ) {
+    return publishAndCollect( getTopic( id ), message, timeout, firstN );
+}
+
+std::future<PublishResult> LocalSkillServiceEngineService::publishAndCollect( const TopicHandle& topic, std::shared_ptr<rapidjson::Document> message, std::chrono::milliseconds timeout, size_t firstN ) {
+    auto promise = std::make_shared<std::promise<PublishResult>>();
+    auto future = promise->get_future();
+    auto state = std::make_shared<CollectState>();
+    state->onResolved = [promise]( PublishResult&& result ) {
+        promise->set_value( std::move( result ) );
+    };
+    state->start = std::chrono::steady_clock::now();
+    state->required = firstN;
+    auto deadline = deadlineAfter( state->start, timeout );
+    {
+        std::lock_guard<std::mutex> guard( state->mutex );
+        state->timer = m_timerQueue.schedule( deadline, [this, state] {
+            std::lock_guard<std::mutex> guard( state->mutex );
+            if ( !state->done ) {
+                resolveCollect( state, false );
             }
+        } );
+    }
+    if ( !publish( topic, message, nullptr, deadline, state ) ) {
+        std::lock_guard<std::mutex> guard( state->mutex );
+        if ( !state->done ) {
+            resolveCollect( state, false );
         }
-        
-        if ( m_requestHandlers.find( path ) == m_requestHandlers.end() ) {
-            request->respond( 404, "" );
-            return;
+    }
+    return future;
+}
+
+std::future<SubscriberResponse> LocalSkillServiceEngineService::requestReply( const std::string& id, std::shared_ptr<rapidjson::Document> message, std::chrono::milliseconds timeout ) {
+    return requestReply( getTopic( id ), message, timeout );
+}
+
+std::future<SubscriberResponse> LocalSkillServiceEngineService::requestReply( const TopicHandle& topic, std::shared_ptr<rapidjson::Document> message, std::chrono::milliseconds timeout ) {
+    auto promise = std::make_shared<std::promise<SubscriberResponse>>();
+    auto future = promise->get_future();
+    try {
+        ThrowIfNull( topic, "subscriptionNotFound" );
+        std::vector<std::shared_ptr<Subscriber>> candidates;
+        PublishRequestHandler requestHandler = nullptr;
+        PublishResponseHandler responseHandler = nullptr;
+        {
+            std::lock_guard<std::mutex> guard( topic->m_mutex );
+            requestHandler = topic->m_requestHandler;
+            responseHandler = topic->m_responseHandler;
+            candidates = topic->m_subscriptions.getSubscribers();
         }
-        auto handler = m_requestHandlers[path];
+        removeUnreachable( candidates );
+        ThrowIf( candidates.empty(), "noSubscribers" );
 
-        std::shared_ptr<rapidjson::Document> jsonResponse = std::make_shared<rapidjson::Document>();
-        // send to executor
-        m_handlerExecutor.submit([handler, jsonRequest, jsonResponse, request]() {
-            try {
-                auto path = request->getPath();
-                if ( handler(jsonRequest, jsonResponse) ) {
-                    if ( jsonResponse->IsObject() ) {
-                        rapidjson::StringBuffer sb;
-                        rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-                        jsonResponse->Accept( writer );
-                        AACE_DEBUG(LX(TAG).d("request", path).d("status", 200));
-                        request->respond( 200, sb.GetString() );
-                    }
-                    else {
-                        AACE_DEBUG(LX(TAG).d("request", path).d("status", 204));
-                        request->respond( 204, "" );
-                    }
+        // best recent median latency first
+        std::vector<std::pair<std::chrono::milliseconds, std::shared_ptr<Subscriber>>> ranked;
+        for ( auto& subscriber : candidates ) {
+            ranked.emplace_back( subscriber->getLatencyPercentile( 50, DEFAULT_SUBSCRIBER_LATENCY ), subscriber );
+        }
+        std::stable_sort( ranked.begin(), ranked.end(), []( const std::pair<std::chrono::milliseconds, std::shared_ptr<Subscriber>>& lhs, const std::pair<std::chrono::milliseconds, std::shared_ptr<Subscriber>>& rhs ) {
+            return lhs.first < rhs.first;
+        } );
+
+        auto state = std::make_shared<CollectState>();
+        state->onResolved = [promise]( PublishResult&& result ) {
+            // the first successful reply wins, otherwise report the first failure
+            SubscriberResponse reply;
+            for ( auto& entry : result.responses ) {
+                if ( entry.status == SubscriberResponse::Status::SUCCESS ) {
+                    reply = entry;
+                    break;
                 }
-                else {
-                    AACE_DEBUG(LX(TAG).d("request", path).d("status", 500));
-                    request->respond( 500, "" );
+                if ( reply.status == SubscriberResponse::Status::PENDING && entry.status != SubscriberResponse::Status::PENDING ) {
+                    reply = entry;
                 }
             }
-            catch( std::exception& ex ) {
-                AACE_ERROR(LX(TAG).m("executor").d("reason", ex.what()));
+            promise->set_value( reply );
+        };
+        state->start = std::chrono::steady_clock::now();
+        state->required = 1;
+        state->pending = ranked.size();
+        auto deadline = deadlineAfter( state->start, timeout );
+        auto traceId = LSS_TRACE_SAMPLE();
+        for ( size_t index = 0; index < ranked.size(); index++ ) {
+            auto& subscriber = ranked[ index ].second;
+            SubscriberResponse entry;
+            entry.endpoint = subscriber->getEndpoint();
+            entry.path = subscriber->getPath();
+            state->result.responses.push_back( entry );
+            auto task = std::make_shared<PublishTask>();
+            task->topic = topic;
+            task->subscriber = subscriber;
+            task->message = message;
+            task->requestHandler = requestHandler;
+            task->responseHandler = responseHandler;
+            task->deadline = deadline;
+            task->collect = state;
+            task->collectIndex = index;
+            task->traceId = traceId;
+            task->queued = LSS_TRACE_NOW( traceId );
+            state->standby.push_back( task );
+        }
+        auto hedgeDelay = ranked.front().second->getLatencyPercentile( HEDGE_LATENCY_PERCENTILE, DEFAULT_SUBSCRIBER_LATENCY );
+        hedgeDelay = std::max( std::chrono::milliseconds( 1 ), std::min( hedgeDelay, timeout ) );
+
+        std::lock_guard<std::mutex> guard( state->mutex );
+        state->timer = m_timerQueue.schedule( deadline, [this, state] {
+            std::lock_guard<std::mutex> guard( state->mutex );
+            if ( !state->done ) {
+                resolveCollect( state, false );
             }
-        });
+        } );
+        dispatchStandbyTask( state );
+        if ( !state->standby.empty() ) {
+            state->hedgeTimer = m_timerQueue.schedule( hedgeDelay, [this, state] {
+                std::lock_guard<std::mutex> guard( state->mutex );
+                state->hedgeTimer = 0;
+                if ( !state->done && !state->standby.empty() ) {
+                    LSS_VERBOSE( TAG.c_str(), "hedging", "id", state->standby.front()->topic->getId(), "endpoint", state->standby.front()->subscriber->getEndpoint() );
+                    dispatchStandbyTask( state );
+                }
+            } );
+        }
     }
     catch( std::exception& ex ) {
-        AACE_ERROR(LX(TAG).d("reason", ex.what()));
+        AACE_ERROR(LX(TAG).d("id", topic ? topic->getId() : "").d("reason", ex.what()));
+        SubscriberResponse reply;
+        reply.status = SubscriberResponse::Status::FAILED;
+        promise->set_value( reply );
     }
+    return future;
 }
 
-bool LocalSkillServiceEngineService::readSubscriptions() {
+std::shared_ptr<LocalSkillServiceEngineService::PublishTask> LocalSkillServiceEngineService::createPublishTask( const TopicHandle& topic, std::shared_ptr<Subscriber> subscriber ) {
+    auto task = std::make_shared<PublishTask>();
+    task->topic = topic;
+    task->subscriber = subscriber;
+    task->deadline = std::chrono::steady_clock::time_point::max();
+    task->traceId = LSS_TRACE_SAMPLE();
+    std::lock_guard<std::mutex> guard( topic->m_mutex );
+    task->requestHandler = topic->m_requestHandler;
+    task->responseHandler = topic->m_responseHandler;
+    return task;
+}
+
+bool LocalSkillServiceEngineService::publish( const TopicHandle& topic, std::shared_ptr<rapidjson::Document> message, std::shared_ptr<const std::string> payload, std::chrono::steady_clock::time_point deadline, std::shared_ptr<CollectState> collect ) {
     try {
-        std::lock_guard<std::mutex> guard( m_subscriptionMutex );
-        auto json = m_localStorage->get(LOCAL_SKILL_SERVICE_LOCAL_STORAGE_TABLE, "subscriptions");
-        rapidjson::Document document;
-        document.Parse(json);
-        ThrowIf( document.HasParseError(), GetParseError_En( document.GetParseError() ) );
-        for (auto& itr : document.GetArray()) {
-            ThrowIfNot(itr.HasMember("id") && itr["id"].IsString(), "No id");
-            std::string id = std::string(itr["id"].GetString());
-            if (m_subscriptions.find( id ) == m_subscriptions.end()) {
-                m_subscriptions[ id ] = std::make_shared<Subscriptions>();
-            }
-            ThrowIfNot(itr.HasMember("endpoint") && itr["endpoint"].IsString(), "No endpoint");
-            ThrowIfNot(itr.HasMember("path") && itr["path"].IsString(), "No path");
-            std::shared_ptr<Subscriptions> subscriptions = m_subscriptions[ id ];
-            auto subscriber = std::make_shared<Subscriber>( itr["endpoint"].GetString(), itr["path"].GetString() );
-            subscriptions->add( subscriber );
+        ThrowIfNull( topic, "subscriptionNotFound" );
+        PublishRequestHandler requestHandler = nullptr;
+        PublishResponseHandler responseHandler = nullptr;
+        std::vector<std::shared_ptr<Subscriber>> subscribers;
+        {
+            std::lock_guard<std::mutex> guard( topic->m_mutex );
+            requestHandler = topic->m_requestHandler;
+            responseHandler = topic->m_responseHandler;
+            subscribers = topic->m_subscriptions.getSubscribers();
+        }
+        removeUnreachable( subscribers );
+        if ( collect ) {
+            std::lock_guard<std::mutex> guardCollect( collect->mutex );
+            for ( auto& subscriber : subscribers ) {
+                SubscriberResponse entry;
+                entry.endpoint = subscriber->getEndpoint();
+                entry.path = subscriber->getPath();
+                collect->result.responses.push_back( entry );
+            }
+            collect->pending = subscribers.size();
+            collect->required = collect->required > 0 ? std::min( collect->required, subscribers.size() ) : subscribers.size();
+            if ( collect->pending == 0 && !collect->done ) {
+                resolveCollect( collect, true );
+            }
         }
+        if ( m_capture.isOpen() ) {
+            capturePublish( topic, message, payload );
+        }
+        // the deliveries of one publish share a trace
+        auto traceId = LSS_TRACE_SAMPLE();
+        std::vector<std::shared_ptr<PublishTask>> tasks;
+        tasks.reserve( subscribers.size() );
+        for ( size_t index = 0; index < subscribers.size(); index++ ) {
+            auto& subscriber = subscribers[ index ];
+            auto task = std::make_shared<PublishTask>();
+            task->topic = topic;
+            task->subscriber = subscriber;
+            task->message = message;
+            task->payload = payload;
+            task->requestHandler = requestHandler;
+            task->responseHandler = responseHandler;
+            task->deadline = deadline;
+            task->collect = collect;
+            task->collectIndex = index;
+            task->traceId = traceId;
+            tasks.push_back( std::move( task ) );
+        }
+        // the whole fan-out is queued under one lock
+        schedulePublishTasks( std::move( tasks ) );
         return true;
     }
-    catch ( std::exception& ex ) {
+    catch( std::exception& ex ) {
         AACE_ERROR(LX(TAG).d("reason", ex.what()));
         return false;
     }
 }
 
-bool LocalSkillServiceEngineService::writeSubscriptions() {
-    try {
-        rapidjson::Document document(rapidjson::kArrayType);
-        auto& allocator = document.GetAllocator();
-        for (auto& pair : m_subscriptions) {
-            std::string id = pair.first;
-            auto& subscription = pair.second;
-            for (auto& subscriber : subscription->getSubscribers()) {
-                AACE_DEBUG(LX(TAG).d("id", id).d("endpoint", subscriber->getEndpoint()).d("path", subscriber->getPath()));
-                rapidjson::Value item(rapidjson::kObjectType);
-                item.AddMember("id", id, allocator);
-                item.AddMember("endpoint", subscriber->getEndpoint(), allocator);
-                item.AddMember("path", subscriber->getPath(), allocator);
-                document.PushBack(item, allocator);
-            }
-        }
+void LocalSkillServiceEngineService::capturePublish( const TopicHandle& topic, const std::shared_ptr<rapidjson::Document>& message, const std::shared_ptr<const std::string>& payload ) {
+    if ( payload ) {
+        m_capture.recordPublish( topic->getId(), *payload );
+    }
+    else if ( message && message->IsObject() ) {
         rapidjson::StringBuffer sb;
         rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-        document.Accept(writer);
-        m_localStorage->put(LOCAL_SKILL_SERVICE_LOCAL_STORAGE_TABLE, "subscriptions", sb.GetString());
-        return true;
+        message->Accept( writer );
+        m_capture.recordPublish( topic->getId(), std::string( sb.GetString(), sb.GetSize() ) );
     }
-    catch ( std::exception& ex ) {
-        AACE_ERROR(LX(TAG).d("reason", ex.what()));
-        return false;
+    else {
+        // the message comes from the topic's request handler for each delivery
+        m_capture.recordPublish( topic->getId(), "" );
     }
 }
 
-bool LocalSkillServiceEngineService::addSubscription( const std::string& id, std::shared_ptr<Subscriber> subscriber ) {
-    try {
-        std::lock_guard<std::mutex> guard( m_subscriptionMutex );
-        ThrowIfNot( m_subscriptions.find( id ) != m_subscriptions.end(), "subscriptionNotFound");
-        std::shared_ptr<Subscriptions> subscriptions = m_subscriptions[ id ];
-        if ( subscriptions->add( subscriber ) ) {
-            AACE_DEBUG(LX(TAG).d("id", id).d("endpoint", subscriber->getEndpoint()).d("path", subscriber->getPath()));
-            writeSubscriptions();
+uint64_t LocalSkillServiceEngineService::getExpiredMessageCount( const std::string& id ) {
+    auto topic = getTopic( id );
+    return topic ? topic->getExpiredMessageCount() : 0;
+}
+
+std::shared_ptr<rapidjson::Document> LocalSkillServiceEngineService::getMetrics() {
+    auto document = std::make_shared<rapidjson::Document>();
+    buildMetrics( *document );
+    return document;
+}
+
+size_t LocalSkillServiceEngineService::getStatusSlot( int status ) {
+    static const size_t count = sizeof( ROUTE_STATUS_CODES ) / sizeof( ROUTE_STATUS_CODES[0] );
+    static_assert( count + 1 == ROUTE_STATUS_SLOTS, "every route status needs a histogram slot" );
+    for ( size_t slot = 0; slot < count; slot++ ) {
+        if ( ROUTE_STATUS_CODES[slot] == status ) {
+            return slot;
         }
-        else {
-            AACE_DEBUG(LX(TAG).d("id", id).d("endpoint", subscriber->getEndpoint()).d("path", subscriber->getPath()).d("reason", "subscriberFound"));
+    }
+    return count;
+}
+
+void LocalSkillServiceEngineService::buildMetrics( rapidjson::Document& document ) {
+    document.SetObject();
+    auto& allocator = document.GetAllocator();
+
+    rapidjson::Value executors( rapidjson::kObjectType );
+    executors.AddMember( "handlerQueueDepth", static_cast<uint64_t>( m_handlerExecutor.getQueueDepth() ), allocator );
+    executors.AddMember( "publishQueueDepth", static_cast<uint64_t>( m_publishExecutor.getQueueDepth() ), allocator );
+    executors.AddMember( "requestQueueDepth", static_cast<uint64_t>( m_requestExecutor.getQueueDepth() ), allocator );
+    executors.AddMember( "localQueueDepth", static_cast<uint64_t>( m_localExecutor.getQueueDepth() ), allocator );
+    {
+        std::lock_guard<std::mutex> guard( m_publishQueueMutex );
+        executors.AddMember( "pendingDeliveries", static_cast<uint64_t>( m_publishQueue.size() ), allocator );
+    }
+    document.AddMember( "executors", executors, allocator );
+
+    rapidjson::Value routes( rapidjson::kObjectType );
+    {
+        InstrumentedLock guard( m_handlerMutex, "buildMetrics" );
+        for ( auto& pair : m_requestHandlers ) {
+            auto& metrics = *pair.second.metrics;
+            rapidjson::Value totals( rapidjson::kObjectType );
+            for ( size_t slot = 0; slot < ROUTE_STATUS_SLOTS; slot++ ) {
+                if ( metrics.total[slot].getCount() == 0 ) {
+                    continue;
+                }
+                std::string status = slot + 1 < ROUTE_STATUS_SLOTS ? std::to_string( ROUTE_STATUS_CODES[slot] ) : "other";
+                rapidjson::Value key( status, allocator );
+                rapidjson::Value histogram = metrics.total[slot].toJson( allocator );
+                totals.AddMember( key, histogram, allocator );
+            }
+            rapidjson::Value route( rapidjson::kObjectType );
+            route.AddMember( "queueWait", metrics.queueWait.toJson( allocator ), allocator );
+            route.AddMember( "run", metrics.run.toJson( allocator ), allocator );
+            route.AddMember( "total", totals, allocator );
+            rapidjson::Value path( pair.first, allocator );
+            routes.AddMember( path, route, allocator );
+        }
+    }
+    document.AddMember( "routes", routes, allocator );
+
+    rapidjson::Value topics( rapidjson::kObjectType );
+    {
+        InstrumentedLock guard( m_subscriptionMutex, "buildMetrics" );
+        for ( auto& pair : m_topics ) {
+            std::vector<std::shared_ptr<Subscriber>> subscribers;
+            {
+                std::lock_guard<std::mutex> guardTopic( pair.second->m_mutex );
+                subscribers = pair.second->m_subscriptions.getSubscribers();
+            }
+            rapidjson::Value list( rapidjson::kArrayType );
+            for ( auto& subscriber : subscribers ) {
+                auto& metrics = subscriber->getMetrics();
+                rapidjson::Value item( rapidjson::kObjectType );
+                item.AddMember( "endpoint", subscriber->getEndpoint(), allocator );
+                item.AddMember( "path", subscriber->getPath(), allocator );
+                item.AddMember( "deliveries", metrics.latency.toJson( allocator ), allocator );
+                item.AddMember( "retries", metrics.retries.load(), allocator );
+                item.AddMember( "failures", metrics.failures.load(), allocator );
+                rapidjson::Value liveness( getLivenessName( subscriber->getLiveness() ), allocator );
+                item.AddMember( "liveness", liveness, allocator );
+                list.PushBack( item, allocator );
+            }
+            rapidjson::Value topic( rapidjson::kObjectType );
+            topic.AddMember( "expired", pair.second->getExpiredMessageCount(), allocator );
+            topic.AddMember( "subscribers", list, allocator );
+            rapidjson::Value id( pair.first, allocator );
+            topics.AddMember( id, topic, allocator );
         }
+    }
+    document.AddMember( "topics", topics, allocator );
+
+    rapidjson::Value locks( rapidjson::kObjectType );
+    locks.AddMember( "handlerMutex", m_handlerMutex.toJson( allocator ), allocator );
+    locks.AddMember( "subscriptionMutex", m_subscriptionMutex.toJson( allocator ), allocator );
+    document.AddMember( "locks", locks, allocator );
+}
+
+void LocalSkillServiceEngineService::schedulePublishTask( std::shared_ptr<PublishTask> task ) {
+    if ( submitLocalPublishTask( task ) ) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard( m_publishQueueMutex );
+        task->sequence = m_publishSequence++;
+        task->queued = LSS_TRACE_NOW( task->traceId );
+        m_publishQueue.push( std::move( task ) );
+        if ( m_publishDrainScheduled ) {
+            return;
+        }
+        m_publishDrainScheduled = true;
+    }
+    submitPublishDrain();
+}
+
+void LocalSkillServiceEngineService::schedulePublishTasks( std::vector<std::shared_ptr<PublishTask>> tasks ) {
+    tasks.erase( std::remove_if( tasks.begin(), tasks.end(), [this]( const std::shared_ptr<PublishTask>& task ) {
+        return submitLocalPublishTask( task );
+    } ), tasks.end() );
+    if ( tasks.empty() ) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard( m_publishQueueMutex );
+        for ( auto& task : tasks ) {
+            task->sequence = m_publishSequence++;
+            task->queued = LSS_TRACE_NOW( task->traceId );
+            m_publishQueue.push( std::move( task ) );
+        }
+        if ( m_publishDrainScheduled ) {
+            return;
+        }
+        m_publishDrainScheduled = true;
+    }
+    submitPublishDrain();
+}
+
+// a local task that does not fit the local queue waits in the publish queue instead
+bool LocalSkillServiceEngineService::submitLocalPublishTask( const std::shared_ptr<PublishTask>& task ) {
+    if ( !task->subscriber->isLocal() ) {
+        return false;
+    }
+    task->queued = LSS_TRACE_NOW( task->traceId );
+    return m_localExecutor.submit( std::bind( &LocalSkillServiceEngineService::runLocalPublishTask, this, task ) );
+}
+
+void LocalSkillServiceEngineService::runLocalPublishTask( const std::shared_ptr<PublishTask>& task ) {
+    if ( task->collect && task->collect->done ) {
+        return;
+    }
+    if ( std::chrono::steady_clock::now() >= task->deadline ) {
+        task->topic->m_expiredMessageCount++;
+        LSS_WARN( TAG.c_str(), "dropping", "id", task->topic->getId(), "endpoint", task->subscriber->getEndpoint(), "reason", "deadlineExpired" );
+        completePublishTask( task, SubscriberResponse::Status::EXPIRED, 0, nullptr );
+        return;
+    }
+    publishMessageToSubscriber( task );
+}
+
+void LocalSkillServiceEngineService::submitPublishDrain() {
+    if ( !m_publishExecutor.submit( std::bind( &LocalSkillServiceEngineService::drainPublishQueue, this ) ) ) {
+        std::lock_guard<std::mutex> guard( m_publishQueueMutex );
+        m_publishDrainScheduled = false;
+        AACE_ERROR(LX(TAG).d("reason", "publishExecutorUnavailable"));
+    }
+}
+
+void LocalSkillServiceEngineService::drainPublishQueue() {
+    // always runs whichever queued task has the earliest deadline
+    for ( ;; ) {
+        std::shared_ptr<PublishTask> task;
+        bool expired = false;
+        {
+            std::lock_guard<std::mutex> guard( m_publishQueueMutex );
+            if ( m_publishQueue.empty() ) {
+                m_publishDrainScheduled = false;
+                return;
+            }
+            task = m_publishQueue.top();
+            m_publishQueue.pop();
+            expired = std::chrono::steady_clock::now() >= task->deadline;
+        }
+        if ( task->collect && task->collect->done ) {
+            // the caller already has its result, so this is not an expired drop
+            continue;
+        }
+        if ( expired ) {
+            task->topic->m_expiredMessageCount++;
+            LSS_WARN( TAG.c_str(), "dropping", "id", task->topic->getId(), "endpoint", task->subscriber->getEndpoint(), "reason", "deadlineExpired" );
+            completePublishTask( task, SubscriberResponse::Status::EXPIRED, 0, nullptr );
+            continue;
+        }
+        publishMessageToSubscriber( task );
+    }
+}
+
+void LocalSkillServiceEngineService::completePublishTask( std::shared_ptr<PublishTask> task, SubscriberResponse::Status status, long httpStatus, std::shared_ptr<rapidjson::Document> response ) {
+    auto state = task->collect;
+    if ( !state ) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard( state->mutex );
+    if ( state->done ) {
+        return;
+    }
+    auto& entry = state->result.responses[ task->collectIndex ];
+    entry.status = status;
+    entry.httpStatus = httpStatus;
+    entry.latency = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - state->start );
+    entry.response = response;
+    state->pending--;
+    if ( status == SubscriberResponse::Status::SUCCESS ) {
+        state->successes++;
+    }
+    if ( state->successes >= state->required || state->pending == 0 ) {
+        resolveCollect( state, true );
+    }
+    else if ( status != SubscriberResponse::Status::SUCCESS && !state->standby.empty() ) {
+        // fall through to the next request/reply candidate without waiting for the hedge delay
+        dispatchStandbyTask( state );
+    }
+}
+
+// must be called with state->mutex held
+void LocalSkillServiceEngineService::resolveCollect( std::shared_ptr<CollectState> state, bool complete ) {
+    state->done = true;
+    state->result.complete = complete;
+    if ( state->timer != 0 ) {
+        m_timerQueue.cancel( state->timer );
+    }
+    if ( state->hedgeTimer != 0 ) {
+        m_timerQueue.cancel( state->hedgeTimer );
+    }
+    state->standby.clear();
+    auto onResolved = std::move( state->onResolved );
+    onResolved( std::move( state->result ) );
+}
+
+// must be called with state->mutex held
+void LocalSkillServiceEngineService::dispatchStandbyTask( std::shared_ptr<CollectState> state ) {
+    auto task = std::move( state->standby.front() );
+    state->standby.pop_front();
+    if ( !m_requestExecutor.submit( std::bind( &LocalSkillServiceEngineService::runRequestTask, this, std::move( task ) ) ) ) {
+        AACE_ERROR(LX(TAG).d("reason", "requestExecutorUnavailable"));
+    }
+}
+
+void LocalSkillServiceEngineService::runRequestTask( const std::shared_ptr<PublishTask>& task ) {
+    if ( task->collect->done ) {
+        return;
+    }
+    if ( std::chrono::steady_clock::now() >= task->deadline ) {
+        task->topic->m_expiredMessageCount++;
+        completePublishTask( task, SubscriberResponse::Status::EXPIRED, 0, nullptr );
+        return;
+    }
+    publishMessageToSubscriber( task );
+}
+
+void LocalSkillServiceEngineService::handleRequest( std::shared_ptr<engine::localSkillService::HttpRequest> request ) {
+    try {
+        InstrumentedLock guard( m_handlerMutex, "handleRequest" );
+        
+        auto received = std::chrono::steady_clock::now();
+        auto traceId = LSS_TRACE_SAMPLE();
+
+        // prepare request
+        auto path = request->getPath();
+        auto method = request->getMethod();
+        LSS_VERBOSE( TAG.c_str(), "handleRequest", "request", path, "method", method );
+        if ( m_capture.isOpen() ) {
+            m_capture.recordRequest( method, path, request->getBody() );
+        }
+        std::shared_ptr<rapidjson::Document> jsonRequest = nullptr;
+        if ( method == "POST" ) {
+            LSS_TRACE_SCOPE( traceId, "parse", "request" );
+            // the document is parsed in place and shares ownership of the body it points into
+            auto arena = DocumentPool::acquireArena();
+            auto& body = arena->getBuffer();
+            // the capture above was the last reader of the request body
+            body = request->takeBody();
+            LSS_VERBOSE( TAG.c_str(), "handleRequest", "bodySize", body.size() );
+            jsonRequest = std::shared_ptr<rapidjson::Document>( arena, &arena->getDocument() );
+            if ( !body.empty() && jsonRequest->ParseInsitu( &body[0] ).HasParseError() ) {
+                request->respond( 400, "" );
+                return;
+            }
+        }
+        
+        auto route = m_requestHandlers.find( path );
+        if ( route == m_requestHandlers.end() ) {
+            request->respond( 404, "" );
+            return;
+        }
+        auto handler = route->second.handler;
+
+        // the caller's own timeout takes precedence over the route default
+        auto timeout = route->second.timeout;
+        auto timeoutHeader = request->getHeader( REQUEST_TIMEOUT_HEADER );
+        if ( !timeoutHeader.empty() ) {
+            // only a positive number of milliseconds replaces the route timeout
+            char* end = nullptr;
+            errno = 0;
+            auto value = std::strtoll( timeoutHeader.c_str(), &end, 10 );
+            if ( end != timeoutHeader.c_str() && *end == '\0' && errno == 0 && value > 0 ) {
+                timeout = std::chrono::milliseconds( value );
+            }
+            else {
+                LSS_WARN( TAG.c_str(), "handleRequest", "request", path, "timeout", timeoutHeader, "reason", "invalidRequestTimeout" );
+            }
+        }
+        auto deadline = timeout.count() > 0 ? deadlineAfter( std::chrono::steady_clock::now(), timeout ) : std::chrono::steady_clock::time_point::max();
+
+        std::shared_ptr<rapidjson::Document> jsonResponse = DocumentPool::acquire();
+        // send to executor
+        auto metrics = route->second.metrics;
+        HandlerTask task = { std::move( handler ), std::move( jsonRequest ), std::move( jsonResponse ), request, deadline, metrics, received, traceId };
+        if ( !m_handlerExecutor.submit( std::move( task ) ) ) {
+            LSS_WARN( TAG.c_str(), "handleRequest", "request", path, "status", 503, "reason", "handlerQueueFull" );
+            request->respond( 503, "" );
+            metrics->total[ getStatusSlot( 503 ) ].record( elapsedSince( received ) );
+        }
+    }
+    catch( std::exception& ex ) {
+        AACE_ERROR(LX(TAG).d("reason", ex.what()));
+    }
+}
+
+bool LocalSkillServiceEngineService::readSubscriptions() {
+    bool success = false;
+    std::vector<std::pair<std::string, std::shared_ptr<Subscriber>>> batch;
+    try {
+        ThrowIfNull( m_localStorage, "invalidLocalStorage" );
+        auto start = std::chrono::steady_clock::now();
+        auto json = m_localStorage->get(LOCAL_SKILL_SERVICE_LOCAL_STORAGE_TABLE, "subscriptions");
+        SubscriptionReader reader( [this, &batch]( const std::string& id, const std::string& endpoint, const std::string& path ) {
+            batch.emplace_back( id, std::make_shared<Subscriber>( endpoint, path ) );
+            if ( batch.size() >= SUBSCRIPTION_LOAD_BATCH ) {
+                loadSubscriptions( batch );
+                batch.clear();
+            }
+        } );
+        success = json.empty() || reader.read( json );
+        if ( !success ) {
+            AACE_ERROR(LX(TAG).d("loaded", reader.getLoadedCount()).d("reason", reader.getError()));
+        }
+        if ( reader.getSkippedCount() > 0 ) {
+            AACE_WARN(LX(TAG).d("skipped", reader.getSkippedCount()).d("reason", "invalidSubscription"));
+        }
+        AACE_INFO(LX(TAG).d("loaded", reader.getLoadedCount()).d("durationMs", std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start ).count()));
+    }
+    catch ( std::exception& ex ) {
+        AACE_ERROR(LX(TAG).d("reason", ex.what()));
+    }
+
+    // entries read before a failure are kept, and the writes deferred while loading are applied now
+    loadSubscriptions( batch );
+    InstrumentedLock guard( m_subscriptionMutex, "readSubscriptions" );
+    m_subscriptionsLoaded = true;
+    m_removedWhileLoading.clear();
+    if ( m_subscriptionsDirty ) {
+        writeSubscriptions();
+    }
+    // the capture opens before the persisted subscriptions load; record them as a /subscribe so a replay delivers to them
+    if ( m_capture.isOpen() ) {
+        try {
+            m_capture.recordRequest( "POST", "/subscribe", serializeSubscriptions() );
+        }
+        catch ( std::exception& ex ) {
+            AACE_ERROR(LX(TAG).d("reason", ex.what()));
+        }
+    }
+    return success;
+}
+
+void LocalSkillServiceEngineService::loadSubscriptions( const std::vector<std::pair<std::string, std::shared_ptr<Subscriber>>>& subscriptions ) {
+    InstrumentedLock guard( m_subscriptionMutex, "loadSubscriptions" );
+    for ( auto& item : subscriptions ) {
+        auto& id = item.first;
+        auto& subscriber = item.second;
+        // unsubscribed before its persisted entry was read
+        if ( m_removedWhileLoading.count( getSubscriptionKey( id, subscriber->getEndpoint(), subscriber->getPath() ) ) > 0 ) {
+            continue;
+        }
+        auto& topic = m_topics[ id ];
+        if ( !topic ) {
+            topic = std::make_shared<Topic>( id );
+        }
+        std::lock_guard<std::mutex> guardTopic( topic->m_mutex );
+        topic->m_subscriptions.add( subscriber );
+    }
+}
+
+void LocalSkillServiceEngineService::probeSubscribers() {
+    try {
+        auto start = std::chrono::steady_clock::now();
+        // topics often share a skill, so every endpoint is probed once for all of its subscriptions
+        std::map<std::string, SubscriptionList> pending;
+        {
+            InstrumentedLock guard( m_subscriptionMutex, "probeSubscribers" );
+            for ( auto& pair : m_topics ) {
+                std::vector<std::shared_ptr<Subscriber>> subscribers;
+                {
+                    std::lock_guard<std::mutex> guardTopic( pair.second->m_mutex );
+                    subscribers = pair.second->m_subscriptions.getSubscribers();
+                }
+                for ( auto& subscriber : subscribers ) {
+                    if ( !subscriber->isLocal() && subscriber->getLiveness() == Subscriber::Liveness::UNKNOWN ) {
+                        pending[ subscriber->getEndpoint() ].emplace_back( pair.second, subscriber );
+                    }
+                }
+            }
+        }
+        size_t live = 0;
+        size_t dead = 0;
+        while ( !pending.empty() ) {
+            std::vector<std::string> endpoints;
+            for ( auto& item : pending ) {
+                endpoints.push_back( item.first );
+            }
+            auto results = EndpointProber::probe( endpoints, PROBE_CONNECT_TIMEOUT );
+            bool expired = std::chrono::steady_clock::now() - start >= m_probeGracePeriod;
+            SubscriptionList prune;
+            auto it = pending.begin();
+            for ( auto result : results ) {
+                auto liveness = Subscriber::Liveness::PENDING;
+                if ( result == EndpointProber::Result::LISTENING ) {
+                    liveness = Subscriber::Liveness::LIVE;
+                    live++;
+                }
+                else if ( result == EndpointProber::Result::UNREACHABLE || expired ) {
+                    liveness = Subscriber::Liveness::DEAD;
+                    dead++;
+                    AACE_WARN(LX(TAG).d("endpoint", it->first).d("reason", "endpointNotListening"));
+                }
+                for ( auto& item : it->second ) {
+                    // a subscriber that subscribed again while being probed stays LIVE
+                    if ( item.second->setProbedLiveness( liveness ) && liveness == Subscriber::Liveness::DEAD ) {
+                        prune.push_back( item );
+                    }
+                }
+                it = liveness == Subscriber::Liveness::PENDING ? std::next( it ) : pending.erase( it );
+            }
+            if ( !prune.empty() ) {
+                removeSubscriptions( prune, true );
+            }
+            if ( pending.empty() ) {
+                break;
+            }
+            std::unique_lock<std::mutex> lock( m_startupMutex );
+            if ( m_startupCondition.wait_for( lock, m_probeInterval, [this]() { return m_startupStopping; } ) ) {
+                break;
+            }
+        }
+        // stopped before these were decided; deliver to them as usual and probe them again on the next start()
+        for ( auto& item : pending ) {
+            for ( auto& subscription : item.second ) {
+                subscription.second->setProbedLiveness( Subscriber::Liveness::UNKNOWN );
+            }
+        }
+        AACE_INFO(LX(TAG).d("live", live).d("dead", dead).d("pending", pending.size()));
+    }
+    catch ( std::exception& ex ) {
+        AACE_ERROR(LX(TAG).d("reason", ex.what()));
+    }
+}
+
+void LocalSkillServiceEngineService::stopStartupThread() {
+    {
+        std::lock_guard<std::mutex> guard( m_startupMutex );
+        m_startupStopping = true;
+    }
+    m_startupCondition.notify_all();
+    if ( m_startupThread.joinable() ) {
+        m_startupThread.join();
+    }
+}
+
+bool LocalSkillServiceEngineService::writeSubscriptions() {
+    // persisting before the load finished would drop the entries not read yet
+    if ( !m_subscriptionsLoaded ) {
+        m_subscriptionsDirty = true;
+        return true;
+    }
+    try {
+        m_localStorage->put(LOCAL_SKILL_SERVICE_LOCAL_STORAGE_TABLE, "subscriptions", serializeSubscriptions());
+        m_subscriptionsDirty = false;
         return true;
     }
     catch ( std::exception& ex ) {
-        AACE_ERROR(LX(TAG).d("id", id).d("endpoint", subscriber->getEndpoint()).d("path", subscriber->getPath()).d("reason", ex.what()));
+        AACE_ERROR(LX(TAG).d("reason", ex.what()));
         return false;
     }
 }
 
-bool LocalSkillServiceEngineService::removeSubscription( const std::string& id, std::shared_ptr<Subscriber> subscriber ) {
-    try {
-        std::lock_guard<std::mutex> guard( m_subscriptionMutex );
-        ThrowIfNot( m_subscriptions.find( id ) != m_subscriptions.end(), "subscriptionNotFound");
-        std::shared_ptr<Subscriptions> subscriptions = m_subscriptions[ id ];
-        if ( subscriptions->remove( subscriber ) ) {
+std::string LocalSkillServiceEngineService::serializeSubscriptions() {
+    rapidjson::Document document(rapidjson::kArrayType);
+    auto& allocator = document.GetAllocator();
+    for (auto& pair : m_topics) {
+        const std::string& id = pair.first;
+        std::vector<std::shared_ptr<Subscriber>> subscribers;
+        {
+            std::lock_guard<std::mutex> guardTopic( pair.second->m_mutex );
+            subscribers = pair.second->m_subscriptions.getSubscribers();
+        }
+        for (auto& subscriber : subscribers) {
+            if ( subscriber->isLocal() ) {
+                continue;
+            }
             AACE_DEBUG(LX(TAG).d("id", id).d("endpoint", subscriber->getEndpoint()).d("path", subscriber->getPath()));
+            rapidjson::Value item(rapidjson::kObjectType);
+            item.AddMember("id", id, allocator);
+            item.AddMember("endpoint", subscriber->getEndpoint(), allocator);
+            item.AddMember("path", subscriber->getPath(), allocator);
+            document.PushBack(item, allocator);
+        }
+    }
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    document.Accept(writer);
+    return std::string( sb.GetString(), sb.GetSize() );
+}
+
+bool LocalSkillServiceEngineService::addSubscription( const TopicHandle& topic, std::shared_ptr<Subscriber> subscriber ) {
+    return addSubscriptions( SubscriptionList{ std::make_pair( topic, subscriber ) } );
+}
+
+bool LocalSkillServiceEngineService::removeSubscription( const TopicHandle& topic, std::shared_ptr<Subscriber> subscriber ) {
+    return removeSubscriptions( SubscriptionList{ std::make_pair( topic, subscriber ) } );
+}
+
+bool LocalSkillServiceEngineService::addSubscriptions( const SubscriptionList& subscriptions ) {
+    try {
+        // the whole list is applied under one lock and persisted once
+        InstrumentedLock guard( m_subscriptionMutex, "addSubscriptions" );
+        bool persist = false;
+        for ( auto& item : subscriptions ) {
+            auto& topic = item.first;
+            auto& subscriber = item.second;
+            bool added = false;
+            {
+                std::lock_guard<std::mutex> guardTopic( topic->m_mutex );
+                added = topic->m_subscriptions.add( subscriber );
+                if ( !subscriber->isLocal() ) {
+                    // subscribing proves the skill is up, also for an entry loaded earlier and still being probed
+                    auto current = added ? subscriber : topic->m_subscriptions.find( subscriber );
+                    current->setLiveness( Subscriber::Liveness::LIVE );
+                }
+            }
+            if ( !m_subscriptionsLoaded ) {
+                m_removedWhileLoading.erase( getSubscriptionKey( topic->getId(), subscriber->getEndpoint(), subscriber->getPath() ) );
+            }
+            if ( added ) {
+                AACE_DEBUG(LX(TAG).d("id", topic->getId()).d("endpoint", subscriber->getEndpoint()).d("path", subscriber->getPath()));
+                persist = persist || !subscriber->isLocal();
+            }
+            else {
+                AACE_DEBUG(LX(TAG).d("id", topic->getId()).d("endpoint", subscriber->getEndpoint()).d("path", subscriber->getPath()).d("reason", "subscriberFound"));
+            }
+        }
+        if ( persist ) {
             writeSubscriptions();
         }
-        else {
-            AACE_DEBUG(LX(TAG).d("id", id).d("endpoint", subscriber->getEndpoint()).d("path", subscriber->getPath()).d("reason", "subscriberNotFound"));
+        return true;
+    }
+    catch ( std::exception& ex ) {
+        AACE_ERROR(LX(TAG).d("count", subscriptions.size()).d("reason", ex.what()));
+        return false;
+    }
+}
+
+bool LocalSkillServiceEngineService::removeSubscriptions( const SubscriptionList& subscriptions, bool deadOnly ) {
+    try {
+        InstrumentedLock guard( m_subscriptionMutex, "removeSubscriptions" );
+        bool persist = false;
+        for ( auto& item : subscriptions ) {
+            auto& topic = item.first;
+            auto& subscriber = item.second;
+            bool removed = false;
+            {
+                std::lock_guard<std::mutex> guardTopic( topic->m_mutex );
+                if ( deadOnly ) {
+                    auto current = topic->m_subscriptions.find( subscriber );
+                    if ( !current || current->getLiveness() != Subscriber::Liveness::DEAD ) {
+                        continue;
+                    }
+                }
+                removed = topic->m_subscriptions.remove( subscriber );
+            }
+            if ( !m_subscriptionsLoaded && !subscriber->isLocal() ) {
+                // the persisted entry may not have been read yet; keep the loader from adding it back
+                m_removedWhileLoading.insert( getSubscriptionKey( topic->getId(), subscriber->getEndpoint(), subscriber->getPath() ) );
+                persist = true;
+            }
+            if ( removed ) {
+                AACE_DEBUG(LX(TAG).d("id", topic->getId()).d("endpoint", subscriber->getEndpoint()).d("path", subscriber->getPath()));
+                persist = persist || !subscriber->isLocal();
+            }
+            else {
+                AACE_DEBUG(LX(TAG).d("id", topic->getId()).d("endpoint", subscriber->getEndpoint()).d("path", subscriber->getPath()).d("reason", "subscriberNotFound"));
+            }
+        }
+        if ( persist ) {
+            writeSubscriptions();
         }
         return true;
     }
     catch ( std::exception& ex ) {
-        AACE_ERROR(LX(TAG).d("id", id).d("endpoint", subscriber->getEndpoint()).d("path", subscriber->getPath()).d("reason", ex.what()));
+        AACE_ERROR(LX(TAG).d("count", subscriptions.size()).d("reason", ex.what()));
         return false;
     }
 }
 
-bool LocalSkillServiceEngineService::publishMessageToSubscriber( const std::string& id, std::shared_ptr<Subscriber> subscriber, std::shared_ptr<rapidjson::Document> message, PublishRequestHandler requestHandler, PublishResponseHandler responseHandler ) {
+bool LocalSkillServiceEngineService::publishMessageToSubscriber( std::shared_ptr<PublishTask> task ) {
+    LSS_TRACE_SPAN( task->traceId, "queue", "delivery", task->queued, std::chrono::steady_clock::now(), task->subscriber->getEndpoint() );
+    if ( task->subscriber->isLocal() ) {
+        return publishMessageToLocalSubscriber( task );
+    }
+    LSS_TRACE_SCOPE( task->traceId, "delivery", "delivery", task->topic->getId() );
+    auto& id = task->topic->getId();
+    auto& subscriber = task->subscriber;
+    auto& message = task->message;
+    auto& requestHandler = task->requestHandler;
+    auto& responseHandler = task->responseHandler;
     bool remove = false;
+    auto outcome = SubscriberResponse::Status::FAILED;
+    long status = 0;
     try {
         std::shared_ptr<rapidjson::Document> request = nullptr;
-        long status = 0;
-        std::string data;
-        std::string payload;
-        std::unique_ptr<CURL, std::function<void(CURL *)>> curl(curl_easy_init(), curl_easy_cleanup);
-        std::string url = "http://localhost" + subscriber->getPath();
-        ThrowIfNull(curl, "curl_easy_init failed");
-        ThrowIfNot( curl_easy_setopt( curl.get(), CURLOPT_URL, url.c_str() ) == CURLE_OK, "setServerUrlFailed" );
-        ThrowIfNot( curl_easy_setopt(curl.get(), CURLOPT_UNIX_SOCKET_PATH, subscriber->getEndpoint().c_str() ) == CURLE_OK, "setSocketPathFailed" );
-        if (message ) {
-            request = message;
-        }
-        else if ( requestHandler ) {
-            request = std::make_shared<rapidjson::Document>();
-            ThrowIfNot( requestHandler( request ), "requestHandlerFailed" );
-        }
-        if ( request && request->IsObject() ) {
-            rapidjson::StringBuffer sb;
-            rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+        std::shared_ptr<rapidjson::Document> response = nullptr;
+        // the response is received straight into a pooled arena and parsed in place
+        auto responseArena = DocumentPool::acquireArena();
+        std::string& data = responseArena->getBuffer();
+        std::shared_ptr<const std::string> payload = task->payload;
+        const char* postData = payload ? payload->data() : nullptr;
+        size_t postSize = payload ? payload->size() : 0;
+        // the request handler runs before the worker's context is taken, in case it publishes itself
+        if ( !payload ) {
+            if ( message ) {
+                request = message;
+            }
+            else if ( requestHandler ) {
+                request = DocumentPool::acquire();
+                ThrowIfNot( requestHandler( request ), "requestHandlerFailed" );
+            }
+        }
+        std::unique_ptr<DeliveryContext, std::function<void(DeliveryContext *)>> context( acquireDeliveryContext(), releaseDeliveryContext );
+        // pre-serialized payloads are posted as is
+        if ( !payload && request && request->IsObject() ) {
+            rapidjson::Writer<rapidjson::StringBuffer> writer( context->request );
             request->Accept( writer );
-            payload = sb.GetString();
-            AACE_DEBUG(LX(TAG).sensitive("payload", payload));
-            ThrowIfNot( curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDS, payload.c_str() ) == CURLE_OK, "setPayloadFailed" );
-            ThrowIfNot( curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDSIZE, payload.size()) == CURLE_OK, "setPayloadSizeFailed" );
+            postData = context->request.GetString();
+            postSize = context->request.GetSize();
+        }
+        CURL* curl = context->acquireHandle();
+        ThrowIfNull(curl, "curl_easy_init failed");
+        context->url.assign( "http://localhost" );
+        context->url.append( subscriber->getPath() );
+        ThrowIfNot( curl_easy_setopt( curl, CURLOPT_URL, context->url.c_str() ) == CURLE_OK, "setServerUrlFailed" );
+        ThrowIfNot( curl_easy_setopt(curl, CURLOPT_UNIX_SOCKET_PATH, subscriber->getEndpoint().c_str() ) == CURLE_OK, "setSocketPathFailed" );
+        if ( postSize > 0 ) {
+            LSS_VERBOSE( TAG.c_str(), "publishMessageToSubscriber", "payloadSize", postSize );
+            ThrowIfNot( curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postData ) == CURLE_OK, "setPayloadFailed" );
+            ThrowIfNot( curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>( postSize )) == CURLE_OK, "setPayloadSizeFailed" );
+        }
+        ThrowIfNot( curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, 1000L) == CURLE_OK, "setConnectTimeoutFailed" );
+        // never let a delivery run past the message deadline
+        auto timeout = PUBLISH_TIMEOUT;
+        if ( task->deadline != std::chrono::steady_clock::time_point::max() ) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>( task->deadline - std::chrono::steady_clock::now() );
+            if ( remaining.count() <= 0 ) {
+                task->topic->m_expiredMessageCount++;
+                outcome = SubscriberResponse::Status::EXPIRED;
+                Throw( "deadlineExpired" );
+            }
+            timeout = std::min( timeout, remaining );
+        }
+        ThrowIfNot( curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, static_cast<long>( timeout.count() )) == CURLE_OK, "setTimeoutFailed" );
+        ThrowIfNot( curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriteCallback ) == CURLE_OK, "setWriteFunctionFailed" );
+        ThrowIfNot( curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&data) == CURLE_OK, "writeDataFailed" );
+        if ( task->collect ) {
+            ThrowIfNot( curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L) == CURLE_OK, "setNoProgressFailed" );
+            ThrowIfNot( curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, curlCancelCallback) == CURLE_OK, "setProgressFunctionFailed" );
+            ThrowIfNot( curl_easy_setopt(curl, CURLOPT_XFERINFODATA, (void *)&task->collect->done) == CURLE_OK, "setProgressDataFailed" );
         }
-        ThrowIfNot( curl_easy_setopt(curl.get(), CURLOPT_CONNECTTIMEOUT_MS, 1000L) == CURLE_OK, "setConnectTimeoutFailed" );
-        ThrowIfNot( curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT_MS, 20000L) == CURLE_OK, "setTimeoutFailed" );
-        ThrowIfNot( curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, curlWriteCallback ) == CURLE_OK, "setWriteFunctionFailed" );
-        ThrowIfNot( curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, (void *)&data) == CURLE_OK, "writeDataFailed" );
 
-        AACE_DEBUG(LX(TAG).d("id", id));
+        LSS_VERBOSE( TAG.c_str(), "publishMessageToSubscriber", "id", id );
 
-        auto result = curl_easy_perform( curl.get() );
+        auto started = std::chrono::steady_clock::now();
+        auto result = curl_easy_perform( curl );
+#ifdef LSS_TRACING
+        if ( task->traceId != 0 ) {
+            traceTransfer( task->traceId, curl, started );
+        }
+#endif
         if ((result == CURLE_COULDNT_RESOLVE_HOST)
             || (result == CURLE_COULDNT_CONNECT)) {
             remove = true;
+            outcome = SubscriberResponse::Status::CONNECTION_FAILED;
             Throw("connectionFailed");
         }
+        else if (result == CURLE_ABORTED_BY_CALLBACK) {
+            Throw("cancelled");
+        }
+        else if (result == CURLE_OPERATION_TIMEDOUT && task->collect) {
+            // collected deliveries are bounded by their deadline and are not retried
+            outcome = SubscriberResponse::Status::TIMEOUT;
+            Throw("operationTimeout");
+        }
         else if (result == CURLE_OPERATION_TIMEDOUT) {
-            m_publishExecutor.submit( [this, id, subscriber, message, requestHandler, responseHandler] {
-                publishMessageToSubscriber( id, subscriber, message, requestHandler, responseHandler );
-            } );
-            AACE_WARN(LX(TAG).d("reason","operationTimeout").m("retrying"));
+            // expired retries are dropped by runNextPublishTask before any curl work starts
+            subscriber->getMetrics().retries++;
+            schedulePublishTask( task );
+            LSS_WARN( TAG.c_str(), "retrying", "id", id, "endpoint", subscriber->getEndpoint(), "reason", "operationTimeout" );
             return false;
         }
-        ThrowIfNot( curl_easy_getinfo( curl.get(), CURLINFO_RESPONSE_CODE, &status ) == CURLE_OK, "getInfoFailed" );
-        AACE_DEBUG(LX(TAG).d("status", status).sensitive("response", data));
+        ThrowIfNot( curl_easy_getinfo( curl, CURLINFO_RESPONSE_CODE, &status ) == CURLE_OK, "getInfoFailed" );
+        LSS_VERBOSE( TAG.c_str(), "publishMessageToSubscriber", "status", status, "responseSize", data.size() );
         if ((status < 200) || (status >= 300)) {
             remove = true;
+            outcome = SubscriberResponse::Status::ERROR_RESPONSE;
             Throw("errorResponse");
         }
-        if ( !data.empty() && responseHandler ) {
-            std::shared_ptr<rapidjson::Document> response = std::make_shared<rapidjson::Document>();
-            ThrowIf( response->Parse( data.c_str() ).HasParseError(), "parseResponseFailed");
+        subscriber->recordLatency( elapsedSince( started ) );
+        LSS_TRACE_SCOPE( task->traceId, "responseHandler", "delivery" );
+        if ( !data.empty() && ( responseHandler || task->collect ) ) {
+            response = std::shared_ptr<rapidjson::Document>( responseArena, &responseArena->getDocument() );
+            ThrowIf( response->ParseInsitu( &data[0] ).HasParseError(), "parseResponseFailed");
+        }
+        if ( response && responseHandler ) {
             ThrowIfNot( responseHandler( response ), "responseHandlerFailed");
         }
+        completePublishTask( task, SubscriberResponse::Status::SUCCESS, status, response );
         return true;
     }
     catch ( std::exception& ex ) {
         AACE_ERROR(LX(TAG).d("reason", ex.what()).d("remove", remove));
+        subscriber->getMetrics().failures++;
+        completePublishTask( task, outcome, status, nullptr );
         if (remove) {
-            removeSubscription( id, subscriber );
+            removeSubscription( task->topic, subscriber );
+        }
+        return false;
+    }
+}
+
+bool LocalSkillServiceEngineService::publishMessageToLocalSubscriber( std::shared_ptr<PublishTask> task ) {
+    try {
+        std::shared_ptr<rapidjson::Document> request = task->message;
+        if ( !request && task->payload ) {
+            request = DocumentPool::acquire();
+            ThrowIf( request->Parse( task->payload->c_str(), task->payload->size() ).HasParseError(), "parsePayloadFailed" );
+        }
+        else if ( !request && task->requestHandler ) {
+            request = DocumentPool::acquire();
+            ThrowIfNot( task->requestHandler( request ), "requestHandlerFailed" );
+        }
+        auto response = DocumentPool::acquire();
+        auto started = std::chrono::steady_clock::now();
+        LSS_TRACE_SCOPE( task->traceId, "localHandler", "delivery", task->topic->getId() );
+        ThrowIfNot( task->subscriber->getLocalHandler()( request, response ), "localHandlerFailed" );
+        task->subscriber->recordLatency( elapsedSince( started ) );
+        if ( !response->IsObject() ) {
+            response = nullptr;
         }
+        if ( response && task->responseHandler ) {
+            ThrowIfNot( task->responseHandler( response ), "responseHandlerFailed" );
+        }
+        completePublishTask( task, SubscriberResponse::Status::SUCCESS, 200, response );
+        return true;
+    }
+    catch ( std::exception& ex ) {
+        AACE_ERROR(LX(TAG).d("id", task->topic->getId()).d("name", task->subscriber->getEndpoint()).d("reason", ex.what()));
+        task->subscriber->getMetrics().failures++;
+        completePublishTask( task, SubscriberResponse::Status::FAILED, 0, nullptr );
         return false;
     }
 }
 
+LocalSkillServiceEngineService::SubscriptionList LocalSkillServiceEngineService::parseSubscriptions( const rapidjson::Value& request ) {
+    // a single { id, endpoint, path } object or an array of them
+    SubscriptionList subscriptions;
+    auto parse = [this, &subscriptions]( const rapidjson::Value& item ) {
+        ThrowIfNot( item.IsObject(), "requestPayloadInvalid" );
+        ThrowIfNot( item.HasMember( "id" ) && item["id"].IsString()
+            && item.HasMember( "endpoint" ) && item["endpoint"].IsString()
+            && item.HasMember( "path" ) && item["path"].IsString(), "requestPayloadInvalid" );
+        auto topic = getTopic( item["id"].GetString() );
+        ThrowIfNull( topic, "subscriptionNotFound" );
+        subscriptions.emplace_back( topic, std::make_shared<Subscriber>( item["endpoint"].GetString(), item["path"].GetString() ) );
+    };
+    if ( request.IsArray() ) {
+        for ( auto& item : request.GetArray() ) {
+            parse( item );
+        }
+    }
+    else {
+        parse( request );
+    }
+    return subscriptions;
+}
+
 bool LocalSkillServiceEngineService::subscribeHandler( std::shared_ptr<rapidjson::Document> request, std::shared_ptr<rapidjson::Document> response ) {
-    std::shared_ptr<Subscriber> subscriber = nullptr;
-    std::string id;
     try {
-        ThrowIfNot( request->IsObject(), "requestPayloadIsEmpty" );
-        auto root = request->GetObject();
-        ThrowIfNot( root.HasMember( "id" ) && root["id"].IsString()
-            && root.HasMember( "endpoint" ) && root["endpoint"].IsString()
-            && root.HasMember( "path" ) && root["path"].IsString(), "requestPayloadInvalid" );
-        id = root["id"].GetString();
-        ThrowIfNot( m_subscriptions.find( id ) != m_subscriptions.end(), "subscriptionNotFound");
-        auto endpoint = root["endpoint"].GetString();
-        auto path = root["path"].GetString();
-        subscriber = std::make_shared<Subscriber>( endpoint, path );
-        ThrowIfNull( subscriber, "subscriberInstanceFailed" );
-        ThrowIfNot( addSubscription( id, subscriber ), "addSubscriptionFailed" );
-        RequestHandler subscribeHandler = nullptr;
-        PublishRequestHandler requestHandler = nullptr;
-        PublishResponseHandler responseHandler = nullptr;
-        {
-            std::lock_guard<std::mutex> guardHandler( m_subscriptionMutex );
-            if ( m_subscribeHandlers.find( id ) != m_subscribeHandlers.end() ) {
-                subscribeHandler = m_subscribeHandlers[id];
+        ThrowIfNot( request && ( request->IsObject() || request->IsArray() ), "requestPayloadIsEmpty" );
+        // every entry is validated before any of them is applied
+        auto subscriptions = parseSubscriptions( *request );
+        ThrowIfNot( addSubscriptions( subscriptions ), "addSubscriptionFailed" );
+
+        // bulk requests get one subscribe handler result per entry
+        bool bulk = request->IsArray();
+        if ( bulk ) {
+            response->SetArray();
+        }
+        std::vector<std::shared_ptr<PublishTask>> tasks;
+        for ( auto& item : subscriptions ) {
+            auto& topic = item.first;
+            RequestHandler subscribeHandler = nullptr;
+            {
+                std::lock_guard<std::mutex> guardTopic( topic->m_mutex );
+                subscribeHandler = topic->m_subscribeHandler;
             }
-            if ( m_publishRequestHandlers.find( id ) != m_publishRequestHandlers.end() ) {
-                requestHandler = m_publishRequestHandlers[id];
+            if ( bulk ) {
+                rapidjson::Value result;
+                if ( subscribeHandler ) {
+                    auto document = DocumentPool::acquire();
+                    ThrowIfNot( subscribeHandler( nullptr, document ), "subscribeHandlerFailed" );
+                    result.CopyFrom( *document, response->GetAllocator() );
+                }
+                response->PushBack( result, response->GetAllocator() );
             }
-            if ( m_publishResponseHandlers.find( id ) != m_publishResponseHandlers.end() ) {
-                responseHandler = m_publishResponseHandlers[id];
+            else if ( subscribeHandler ) {
+                ThrowIfNot( subscribeHandler( nullptr, response ), "subscribeHandlerFailed" );
+            }
+            auto task = createPublishTask( topic, item.second );
+            if ( task->requestHandler || task->responseHandler ) {
+                tasks.push_back( task );
             }
         }
-        if ( subscribeHandler ) {
-            ThrowIfNot( subscribeHandler(nullptr, response), "subscribeHandlerFailed");
-        }
-        if ( requestHandler || responseHandler ) {
-            m_publishExecutor.submit( [this, id, subscriber, requestHandler, responseHandler] {
-                publishMessageToSubscriber( id, subscriber, nullptr, requestHandler, responseHandler );
-            } );
-        }
-
+        schedulePublishTasks( std::move( tasks ) );
         return true;
     }
     catch ( std::exception& ex ) {
@@ -456,19 +1823,9 @@ bool LocalSkillServiceEngineService::subscribeHandler( std::shared_ptr<rapidjson
 }
 
 bool LocalSkillServiceEngineService::unsubscribeHandler( std::shared_ptr<rapidjson::Document> request, std::shared_ptr<rapidjson::Document> response ) {
-    std::shared_ptr<Subscriber> subscriber = nullptr;
-    std::string id;
     try {
-        ThrowIfNot( request->IsObject(), "requestPayloadIsEmpty" );
-        auto root = request->GetObject();
-        ThrowIfNot( root.HasMember( "id" ) && root["id"].IsString()
-            && root.HasMember( "endpoint" ) && root["endpoint"].IsString()
-            && root.HasMember( "path" ) && root["path"].IsString(), "requestPayloadInvalid" );
-        id = root["id"].GetString();
-        auto endpoint = root["endpoint"].GetString();
-        auto path = root["path"].GetString();
-        subscriber = std::make_shared<Subscriber>( endpoint, path );
-        ThrowIfNot( removeSubscription( id, subscriber ), "removeSubscriptionFailed" );
+        ThrowIfNot( request && ( request->IsObject() || request->IsArray() ), "requestPayloadIsEmpty" );
+        ThrowIfNot( removeSubscriptions( parseSubscriptions( *request ) ), "removeSubscriptionFailed" );
         return true;
     }
     catch ( std::exception& ex ) {
@@ -477,8 +1834,213 @@ bool LocalSkillServiceEngineService::unsubscribeHandler( std::shared_ptr<rapidjs
     }
 }
 
+void LocalSkillServiceEngineService::batchHandler( std::shared_ptr<rapidjson::Document> request, std::shared_ptr<RequestCompletion> completion ) {
+    try {
+        // either a plain array of requests, or { "parallel": bool, "requests": [...] }
+        ThrowIfNot( request && ( request->IsArray() || request->IsObject() ), "requestPayloadInvalid" );
+        auto state = std::make_shared<BatchState>();
+        const rapidjson::Value* requests = request.get();
+        if ( request->IsObject() ) {
+            auto root = request->GetObject();
+            ThrowIfNot( root.HasMember( "requests" ) && root["requests"].IsArray(), "requestPayloadInvalid" );
+            requests = &root["requests"];
+            if ( root.HasMember( "parallel" ) && root["parallel"].IsBool() ) {
+                state->parallel = root["parallel"].GetBool();
+            }
+        }
+        ThrowIf( requests->Size() > MAX_BATCH_SIZE, "batchTooLarge" );
+
+        state->completion = completion;
+        state->entries.resize( requests->Size() );
+        for ( rapidjson::SizeType index = 0; index < requests->Size(); index++ ) {
+            auto& item = (*requests)[ index ];
+            auto& entry = state->entries[ index ];
+            entry.request = DocumentPool::acquire();
+            entry.response = DocumentPool::acquire();
+            if ( !item.IsObject() || !item.HasMember( "path" ) || !item["path"].IsString() ) {
+                entry.status = 400;
+                continue;
+            }
+            entry.path = item["path"].GetString();
+            if ( item.HasMember( "body" ) ) {
+                entry.request->CopyFrom( item["body"], entry.request->GetAllocator() );
+            }
+        }
+        state->remaining = state->entries.size();
+        if ( state->entries.empty() ) {
+            finishBatch( state );
+        }
+        else if ( state->parallel ) {
+            // every entry is started right away on this handler thread, so handlers stay serialized and only
+            // asynchronous ones overlap; whichever entry completes last answers the batch
+            runBatchEntries( state );
+        }
+        else {
+            // each entry starts once the previous one completed
+            dispatchBatchEntry( state, state->next++ );
+        }
+    }
+    catch ( std::exception& ex ) {
+        AACE_ERROR(LX(TAG).d("reason", ex.what()));
+        completion->complete( false );
+    }
+}
+
+void LocalSkillServiceEngineService::runBatchEntries( std::shared_ptr<BatchState> state ) {
+    for ( ;; ) {
+        auto index = state->next++;
+        if ( index >= state->entries.size() ) {
+            return;
+        }
+        dispatchBatchEntry( state, index );
+    }
+}
+
+void LocalSkillServiceEngineService::dispatchBatchEntry( std::shared_ptr<BatchState> state, size_t index ) {
+    auto& entry = state->entries[ index ];
+    auto onComplete = [this, state, index]( bool success, std::shared_ptr<rapidjson::Document> response ) {
+        auto& entry = state->entries[ index ];
+        if ( entry.status == 0 ) {
+            entry.status = !success ? 500 : response->IsObject() || response->IsArray() ? 200 : 204;
+        }
+        if ( --state->remaining == 0 ) {
+            finishBatch( state );
+        }
+        else if ( !state->parallel ) {
+            // asynchronous handlers complete on other threads, but the next entry runs on the handler executor like any request
+            auto next = state->next++;
+            if ( !m_handlerExecutor.submit( std::bind( &LocalSkillServiceEngineService::dispatchBatchEntry, this, state, next ) ) ) {
+                for ( auto index = next; index < state->entries.size(); index++ ) {
+                    state->entries[ index ].status = 503;
+                }
+                finishBatch( state );
+            }
+        }
+    };
+    if ( entry.status == 0 && entry.path == "/batch" ) {
+        // batches do not nest
+        entry.status = 400;
+    }
+    std::shared_ptr<const AsyncRequestHandler> handler;
+    if ( entry.status == 0 ) {
+        InstrumentedLock guard( m_handlerMutex, "dispatchBatchEntry" );
+        auto it = m_requestHandlers.find( entry.path );
+        if ( it != m_requestHandlers.end() ) {
+            handler = it->second.handler;
+        }
+        else {
+            entry.status = 404;
+        }
+    }
+    // entries share the deadline and cancellation of the batch
+    auto completion = std::make_shared<RequestCompletion>( entry.response, onComplete, state->completion->getDeadline(), state->completion->getCancellationToken() );
+    if ( !handler ) {
+        completion->complete( false );
+        return;
+    }
+    try {
+        ( *handler )( entry.request, completion );
+    }
+    catch ( std::exception& ex ) {
+        AACE_ERROR(LX(TAG).d("path", entry.path).d("reason", ex.what()));
+        completion->complete( false );
+    }
+}
+
+void LocalSkillServiceEngineService::finishBatch( std::shared_ptr<BatchState> state ) {
+    auto response = state->completion->getResponse();
+    response->SetArray();
+    auto& allocator = response->GetAllocator();
+    for ( auto& entry : state->entries ) {
+        rapidjson::Value result( rapidjson::kObjectType );
+        result.AddMember( "status", entry.status, allocator );
+        if ( entry.status == 200 ) {
+            result.AddMember( "body", rapidjson::Value( *entry.response, allocator ), allocator );
+        }
+        response->PushBack( result, allocator );
+    }
+    state->completion->complete( true );
+}
+
+RequestCompletion::RequestCompletion( std::shared_ptr<rapidjson::Document> response, Callback callback, std::chrono::steady_clock::time_point deadline, CancellationToken cancellationToken ) :
+    m_response( response ),
+    m_callback( callback ),
+    m_responder( nullptr ),
+    m_context( nullptr ),
+    m_deadline( deadline ),
+    m_cancellationToken( cancellationToken ),
+    m_completed( false ) {
+}
+
+RequestCompletion::RequestCompletion( std::shared_ptr<rapidjson::Document> response, Responder responder, void* context, std::chrono::steady_clock::time_point deadline, CancellationToken cancellationToken ) :
+    m_response( response ),
+    m_responder( responder ),
+    m_context( context ),
+    m_deadline( deadline ),
+    m_cancellationToken( cancellationToken ),
+    m_completed( false ) {
+}
+
+bool RequestCompletion::isCancelled() const {
+    return ( m_cancellationToken && m_cancellationToken->load() ) || std::chrono::steady_clock::now() >= m_deadline;
+}
+
+RequestCompletion::~RequestCompletion() {
+    // a handler that dropped its completion without answering fails the request instead of leaving it hanging
+    if ( !m_completed ) {
+        AACE_WARN(LX(TAG).d("reason", "completionDropped"));
+        // destructors are noexcept, so a throwing callback must not escape
+        try {
+            complete( false );
+        }
+        catch ( std::exception& ex ) {
+            AACE_ERROR(LX(TAG).d("reason", ex.what()));
+        }
+    }
+}
+
+void RequestCompletion::complete( bool success ) {
+    if ( m_completed.exchange( true ) ) {
+        return;
+    }
+    if ( m_responder != nullptr ) {
+        m_responder( m_context, success, m_response );
+        return;
+    }
+    auto callback = std::move( m_callback );
+    callback( success, m_response );
+}
+
 Subscriber::~Subscriber() = default;
 
+void Subscriber::recordLatency( std::chrono::microseconds elapsed ) {
+    m_metrics.latency.record( elapsed );
+    auto latency = std::chrono::duration_cast<std::chrono::milliseconds>( elapsed );
+    std::lock_guard<std::mutex> guard( m_latencyMutex );
+    if ( m_latencies.size() < SUBSCRIBER_LATENCY_SAMPLES ) {
+        m_latencies.push_back( latency );
+    }
+    else {
+        m_latencies[ m_latencyIndex ] = latency;
+    }
+    m_latencyIndex = ( m_latencyIndex + 1 ) % SUBSCRIBER_LATENCY_SAMPLES;
+}
+
+std::chrono::milliseconds Subscriber::getLatencyPercentile( double percentile, std::chrono::milliseconds fallback ) const {
+    std::vector<std::chrono::milliseconds> samples;
+    {
+        std::lock_guard<std::mutex> guard( m_latencyMutex );
+        samples = m_latencies;
+    }
+    if ( samples.empty() ) {
+        return fallback;
+    }
+    auto rank = static_cast<size_t>( percentile / 100.0 * ( samples.size() - 1 ) + 0.5 );
+    rank = std::min( rank, samples.size() - 1 );
+    std::nth_element( samples.begin(), samples.begin() + rank, samples.end() );
+    return samples[ rank ];
+}
+
 // Subscription::~Subscription() = default;
 
 Subscriptions::~Subscriptions() = default;
@@ -493,6 +2055,15 @@ bool Subscriptions::add( std::shared_ptr<Subscriber> subscriber ) {
     return true;
 }
 
+std::shared_ptr<Subscriber> Subscriptions::find( std::shared_ptr<Subscriber> subscriber ) const {
+    for ( auto const& it: m_subscribers ) {
+        if ( it->isEqual( subscriber ) ) {
+            return it;
+        }
+    }
+    return nullptr;
+}
+
 bool Subscriptions::remove( std::shared_ptr<Subscriber> subscriber ) {
     for ( auto it = m_subscribers.begin(); it != m_subscribers.end(); ++it ) {
         if ( (*it)->isEqual( subscriber ) ) {
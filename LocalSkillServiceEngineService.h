@@ -0,0 +1,582 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOCAL_SKILL_SERVICE_LOCAL_SKILL_SERVICE_ENGINE_SERVICE_H
+#define AACE_ENGINE_LOCAL_SKILL_SERVICE_LOCAL_SKILL_SERVICE_ENGINE_SERVICE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "AACE/Engine/Core/EngineService.h"
+#include "AACE/Engine/Storage/LocalStorageInterface.h"
+#include "AACE/Engine/LocalSkillService/HttpServer.h"
+#include "AACE/Engine/LocalSkillService/InstrumentedMutex.h"
+#include "AACE/Engine/LocalSkillService/LatencyHistogram.h"
+#include "AACE/Engine/LocalSkillService/TaskExecutor.h"
+#include "AACE/Engine/LocalSkillService/TimerQueue.h"
+#include "AACE/Engine/LocalSkillService/TrafficCapture.h"
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+class Subscriber {
+public:
+    /**
+     * Handler of an in-process subscriber. The message is shared with every other local subscriber and must not be modified.
+     */
+    using LocalHandler = std::function<bool(std::shared_ptr<const rapidjson::Document>, std::shared_ptr<rapidjson::Document>)>;
+
+    // what the startup probe found listening on the endpoint; subscribers it never checked stay UNKNOWN
+    enum class Liveness { UNKNOWN, LIVE, PENDING, DEAD };
+
+    Subscriber( const std::string& endpoint, const std::string& path ) : m_endpoint( endpoint ), m_path( path ), m_latencyIndex( 0 ), m_liveness( Liveness::UNKNOWN ) {}
+    Subscriber( const std::string& name, LocalHandler handler ) : m_endpoint( name ), m_localHandler( handler ), m_latencyIndex( 0 ), m_liveness( Liveness::UNKNOWN ) {}
+    ~Subscriber();
+
+    const std::string& getEndpoint() const { return m_endpoint; }
+    const std::string& getPath() const { return m_path; }
+
+    // local subscribers live in the engine process and are neither persisted nor reached over HTTP
+    bool isLocal() const { return m_localHandler != nullptr; }
+    const LocalHandler& getLocalHandler() const { return m_localHandler; }
+
+    Liveness getLiveness() const { return m_liveness.load(); }
+    void setLiveness( Liveness liveness ) { m_liveness = liveness; }
+
+    /**
+     * Records a probe result unless the subscriber was found LIVE or DEAD in the meantime; returns false if it was.
+     */
+    bool setProbedLiveness( Liveness liveness ) {
+        auto current = m_liveness.load();
+        while ( current == Liveness::UNKNOWN || current == Liveness::PENDING ) {
+            if ( m_liveness.compare_exchange_weak( current, liveness ) ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // publishes skip endpoints the probe found dead; a pending one fails fast if it is not listening yet
+    bool isReachable() const {
+        return m_liveness.load() != Liveness::DEAD;
+    }
+
+    bool isEqual( std::shared_ptr<Subscriber> subscriber ) const {
+        return m_endpoint == subscriber->m_endpoint && m_path == subscriber->m_path && isLocal() == subscriber->isLocal();
+    }
+
+    // delivery statistics reported by the /metrics route
+    struct DeliveryMetrics {
+        LatencyHistogram latency;
+        std::atomic<uint64_t> retries{ 0 };
+        std::atomic<uint64_t> failures{ 0 };
+    };
+
+    /**
+     * Records the round trip time of a successful delivery.
+     */
+    void recordLatency( std::chrono::microseconds latency );
+
+    DeliveryMetrics& getMetrics() { return m_metrics; }
+
+    /**
+     * Returns the given percentile (0-100) of the recently recorded latencies, or @c fallback if none were recorded.
+     */
+    std::chrono::milliseconds getLatencyPercentile( double percentile, std::chrono::milliseconds fallback ) const;
+
+private:
+    std::string m_endpoint;
+    std::string m_path;
+    LocalHandler m_localHandler;
+
+    // ring buffer of the most recent delivery latencies
+    std::vector<std::chrono::milliseconds> m_latencies;
+    size_t m_latencyIndex;
+    mutable std::mutex m_latencyMutex;
+
+    DeliveryMetrics m_metrics;
+    std::atomic<Liveness> m_liveness;
+};
+
+class Subscriptions {
+public:
+    Subscriptions() = default;
+    ~Subscriptions();
+
+    bool add( std::shared_ptr<Subscriber> subscriber );
+    bool remove( std::shared_ptr<Subscriber> subscriber );
+    // returns the subscriber equal to @c subscriber, or nullptr
+    std::shared_ptr<Subscriber> find( std::shared_ptr<Subscriber> subscriber ) const;
+    std::vector<std::shared_ptr<Subscriber>> getSubscribers() const { return m_subscribers; }
+
+private:
+    std::vector<std::shared_ptr<Subscriber>> m_subscribers;
+};
+
+/**
+ * Outcome of delivering a published message to a single subscriber.
+ */
+struct SubscriberResponse {
+    enum class Status {
+        // no answer before the result was resolved
+        PENDING,
+        SUCCESS,
+        ERROR_RESPONSE,
+        CONNECTION_FAILED,
+        EXPIRED,
+        TIMEOUT,
+        FAILED
+    };
+
+    std::string endpoint;
+    std::string path;
+    Status status = Status::PENDING;
+    long httpStatus = 0;
+    // time from the publish call until the subscriber answered
+    std::chrono::milliseconds latency{ 0 };
+    std::shared_ptr<rapidjson::Document> response;
+};
+
+/**
+ * Aggregated result of a publishAndCollect() fan-out, with one entry per subscriber.
+ */
+struct PublishResult {
+    std::vector<SubscriberResponse> responses;
+    // true if the fan-out finished, or collected enough responses, before the deadline
+    bool complete = false;
+};
+
+class LocalSkillServiceEngineService;
+
+/**
+ * Completion handle of an asynchronous request. The handler fills in the response document and calls
+ * complete() once, from any thread, after which the caller is answered. Later calls are ignored, and a
+ * completion released without being completed fails the request.
+ */
+class RequestCompletion {
+public:
+    using Callback = std::function<void(bool, std::shared_ptr<rapidjson::Document>)>;
+    using CancellationToken = HttpRequest::CancellationToken;
+    // answers without a capturing callback; @c context is passed back unchanged
+    using Responder = void (*)( void* context, bool success, const std::shared_ptr<rapidjson::Document>& response );
+
+    RequestCompletion( std::shared_ptr<rapidjson::Document> response, Callback callback, std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max(), CancellationToken cancellationToken = nullptr );
+    RequestCompletion( std::shared_ptr<rapidjson::Document> response, Responder responder, void* context, std::chrono::steady_clock::time_point deadline, CancellationToken cancellationToken );
+    ~RequestCompletion();
+
+    std::shared_ptr<rapidjson::Document> getResponse() const { return m_response; }
+
+    /**
+     * Returns true once the caller disconnected or the request deadline passed. Long running handlers
+     * should check this and give up early, since the result can no longer be delivered.
+     */
+    bool isCancelled() const;
+    std::chrono::steady_clock::time_point getDeadline() const { return m_deadline; }
+    const CancellationToken& getCancellationToken() const { return m_cancellationToken; }
+
+    void complete( bool success );
+
+private:
+    std::shared_ptr<rapidjson::Document> m_response;
+    Callback m_callback;
+    Responder m_responder;
+    void* m_context;
+    std::chrono::steady_clock::time_point m_deadline;
+    CancellationToken m_cancellationToken;
+    std::atomic<bool> m_completed;
+};
+
+/**
+ * Registry record of a publish topic, holding its subscribers, handlers and counters in one place.
+ * Handles are returned by LocalSkillServiceEngineService::registerTopic() and let producers publish
+ * without looking the topic up by name.
+ */
+class Topic {
+public:
+    explicit Topic( const std::string& id ) : m_id( id ), m_expiredMessageCount( 0 ) {}
+
+    const std::string& getId() const { return m_id; }
+
+    /**
+     * Returns the number of deliveries for the topic that were dropped because their deadline had passed.
+     */
+    uint64_t getExpiredMessageCount() const { return m_expiredMessageCount; }
+
+private:
+    friend class LocalSkillServiceEngineService;
+
+    const std::string m_id;
+    Subscriptions m_subscriptions;
+    std::function<bool(std::shared_ptr<rapidjson::Document>, std::shared_ptr<rapidjson::Document>)> m_subscribeHandler;
+    std::function<bool(std::shared_ptr<rapidjson::Document>)> m_requestHandler;
+    std::function<bool(std::shared_ptr<rapidjson::Document>)> m_responseHandler;
+    std::atomic<uint64_t> m_expiredMessageCount;
+    // guards the subscriptions and handlers
+    std::mutex m_mutex;
+};
+
+using TopicHandle = std::shared_ptr<Topic>;
+
+class LocalSkillServiceEngineService :
+    public aace::engine::core::EngineService,
+    public std::enable_shared_from_this<LocalSkillServiceEngineService> {
+
+public:
+    DESCRIBE("aace.localSkillService",VERSION("1.0"))
+
+    using RequestHandler = std::function<bool(std::shared_ptr<rapidjson::Document>, std::shared_ptr<rapidjson::Document>)>;
+    using AsyncRequestHandler = std::function<void(std::shared_ptr<rapidjson::Document>, std::shared_ptr<RequestCompletion>)>;
+    using PublishRequestHandler = std::function<bool(std::shared_ptr<rapidjson::Document>)>;
+    using PublishResponseHandler = std::function<bool(std::shared_ptr<rapidjson::Document>)>;
+
+private:
+    LocalSkillServiceEngineService( const aace::engine::core::ServiceDescription& description );
+
+public:
+    virtual ~LocalSkillServiceEngineService();
+
+    /**
+     * Creates, configures and starts a service outside of an engine, persisting subscriptions to @c localStorage
+     * instead of the engine storage service. The service stops when the last reference is released.
+     * Used by the benchmark; returns nullptr if the service could not be configured or started.
+     */
+    static std::shared_ptr<LocalSkillServiceEngineService> createStandalone( std::shared_ptr<std::istream> configuration, std::shared_ptr<aace::engine::storage::LocalStorageInterface> localStorage );
+
+    /**
+     * Registers a handler for @c path. Requests that carry no X-Request-Timeout header (in milliseconds) get
+     * @c timeout as their deadline, zero meaning none; requests still queued past their deadline are answered
+     * with 504 without running the handler.
+     */
+    void registerHandler( const std::string& path, RequestHandler handler, std::chrono::milliseconds timeout = std::chrono::milliseconds( 0 ) );
+
+    /**
+     * Registers a handler that answers through a RequestCompletion instead of its return value. The handler
+     * should return as soon as it has started its work, and complete the request when the work finishes, so
+     * waiting on engine state or I/O does not hold an executor thread.
+     */
+    void registerAsyncHandler( const std::string& path, AsyncRequestHandler handler, std::chrono::milliseconds timeout = std::chrono::milliseconds( 0 ) );
+
+    /**
+     * Runs the handler registered for @c path on the calling thread, without going through the HTTP server.
+     * Blocks until an asynchronous handler completes, or returns false once the route timeout passed.
+     */
+    bool invokeHandler( const std::string& path, std::shared_ptr<rapidjson::Document> request, std::shared_ptr<rapidjson::Document> response );
+
+    /**
+     * Subscribes an in-process handler to a topic. Published documents are handed over by shared reference,
+     * with no serialization or socket I/O. Local subscriptions are not persisted.
+     */
+    bool subscribeLocal( const std::string& id, const std::string& name, Subscriber::LocalHandler handler );
+    bool unsubscribeLocal( const std::string& id, const std::string& name );
+
+    /**
+     * Registers a publish topic, or updates the handlers of an existing one, and returns its handle.
+     * Publishing through the handle skips the lookup by name.
+     */
+    TopicHandle registerTopic( const std::string& id, RequestHandler subscribeHandler = nullptr, PublishRequestHandler requestHandler = nullptr, PublishResponseHandler responseHandler = nullptr );
+
+    /**
+     * Returns the handle of a registered topic, or @c nullptr if there is none.
+     */
+    TopicHandle getTopic( const std::string& id );
+
+    bool registerPublishHandler( const std::string& id, RequestHandler subscribeHandler = nullptr, PublishRequestHandler requestHandler = nullptr, PublishResponseHandler responseHandler = nullptr );
+    bool publishMessage( const std::string& id, std::shared_ptr<rapidjson::Document> message );
+    bool publishMessage( const std::string& id, std::nullptr_t );
+
+    /**
+     * Publishes a message that is only delivered while its time-to-live has not elapsed.
+     * Deliveries still queued when the TTL expires are dropped and counted against the topic.
+     */
+    bool publishMessage( const std::string& id, std::shared_ptr<rapidjson::Document> message, std::chrono::milliseconds ttl );
+
+    /**
+     * Publishes a message that is only delivered before the given absolute deadline.
+     */
+    bool publishMessage( const std::string& id, std::shared_ptr<rapidjson::Document> message, std::chrono::steady_clock::time_point deadline );
+
+    /**
+     * Publishes an already serialized JSON payload. The buffer is shared by every delivery and is
+     * posted to subscribers as is, without building a document.
+     */
+    bool publishMessage( const std::string& id, std::shared_ptr<const std::string> payload, std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max() );
+    bool publishMessage( const std::string& id, std::shared_ptr<const std::string> payload, std::chrono::milliseconds ttl );
+
+    /**
+     * Publishes any type that provides a @c writeJson( rapidjson::Writer<rapidjson::StringBuffer>&, const T& )
+     * overload (found by argument dependent lookup). The value is streamed straight into the payload buffer.
+     */
+    template <typename T, typename = decltype( writeJson( std::declval<rapidjson::Writer<rapidjson::StringBuffer>&>(), std::declval<const T&>() ) )>
+    bool publishMessage( const std::string& id, const T& message, std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max() ) {
+        auto payload = serializeMessage( message );
+        return payload && publishMessage( id, payload, deadline );
+    }
+
+    /**
+     * Publishes through a topic handle, without looking the topic up by name.
+     */
+    bool publishMessage( const TopicHandle& topic, std::shared_ptr<rapidjson::Document> message, std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max() );
+    bool publishMessage( const TopicHandle& topic, std::nullptr_t );
+    bool publishMessage( const TopicHandle& topic, std::shared_ptr<const std::string> payload, std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max() );
+
+    template <typename T, typename = decltype( writeJson( std::declval<rapidjson::Writer<rapidjson::StringBuffer>&>(), std::declval<const T&>() ) )>
+    bool publishMessage( const TopicHandle& topic, const T& message, std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max() ) {
+        auto payload = serializeMessage( message );
+        return payload && publishMessage( topic, payload, deadline );
+    }
+
+    /**
+     * Publishes a message and returns a future for the subscriber responses. The future resolves once
+     * every subscriber answered, once @c firstN subscribers answered successfully (if non-zero), or
+     * when @c timeout elapses, whichever comes first. Deliveries still queued at that point are dropped.
+     */
+    std::future<PublishResult> publishAndCollect( const std::string& id, std::shared_ptr<rapidjson::Document> message, std::chrono::milliseconds timeout, size_t firstN = 0 );
+    std::future<PublishResult> publishAndCollect( const TopicHandle& topic, std::shared_ptr<rapidjson::Document> message, std::chrono::milliseconds timeout, size_t firstN = 0 );
+
+    /**
+     * Sends a request to the single subscriber of the topic with the best recent latency and returns a future
+     * for its reply. If no reply arrives within that subscriber's recent high-percentile latency, a hedged
+     * duplicate is sent to the next best subscriber; failures fall through to the next candidate immediately.
+     * The first successful reply wins and the remaining deliveries are cancelled.
+     */
+    std::future<SubscriberResponse> requestReply( const std::string& id, std::shared_ptr<rapidjson::Document> message, std::chrono::milliseconds timeout );
+    std::future<SubscriberResponse> requestReply( const TopicHandle& topic, std::shared_ptr<rapidjson::Document> message, std::chrono::milliseconds timeout );
+
+    /**
+     * Returns the number of deliveries for the topic that were dropped because their deadline had passed.
+     */
+    uint64_t getExpiredMessageCount( const std::string& id );
+
+    /**
+     * Returns a snapshot of the service metrics, as also served by the /metrics route: latency histograms
+     * per route and response status, delivery statistics per topic and subscriber, and executor queue depths.
+     * Lock wait and hold times per call site are included when enabled with @c lssLockMetrics.
+     */
+    std::shared_ptr<rapidjson::Document> getMetrics();
+
+protected:
+    bool configure( std::shared_ptr<std::istream> configuration ) override;
+    bool start() override;
+    bool stop() override;
+
+private:
+    template <typename T>
+    static std::shared_ptr<const std::string> serializeMessage( const T& message ) {
+        rapidjson::StringBuffer sb;
+        rapidjson::Writer<rapidjson::StringBuffer> writer( sb );
+        if ( !writeJson( writer, message ) || !writer.IsComplete() ) {
+            return nullptr;
+        }
+        return std::make_shared<const std::string>( sb.GetString(), sb.GetSize() );
+    }
+
+    struct PublishTask;
+
+    // response aggregation shared by the deliveries of one publishAndCollect() or requestReply() call
+    struct CollectState {
+        std::mutex mutex;
+        std::function<void( PublishResult&& )> onResolved;
+        PublishResult result;
+        std::chrono::steady_clock::time_point start;
+        size_t pending = 0;
+        size_t successes = 0;
+        size_t required = 0;
+        // read without the mutex by in-flight deliveries to abort once the result is resolved
+        std::atomic<bool> done{ false };
+        TimerQueue::TimerId timer = 0;
+        // request/reply candidates that have not been sent yet, best first
+        std::deque<std::shared_ptr<PublishTask>> standby;
+        TimerQueue::TimerId hedgeTimer = 0;
+    };
+
+    // a single pending delivery of a message to one subscriber
+    struct PublishTask {
+        TopicHandle topic;
+        std::shared_ptr<Subscriber> subscriber;
+        std::shared_ptr<rapidjson::Document> message;
+        std::shared_ptr<const std::string> payload;
+        PublishRequestHandler requestHandler;
+        PublishResponseHandler responseHandler;
+        std::chrono::steady_clock::time_point deadline;
+        uint64_t sequence;
+        std::shared_ptr<CollectState> collect;
+        size_t collectIndex;
+        // non-zero when the delivery is traced; queued is only set then
+        uint64_t traceId = 0;
+        std::chrono::steady_clock::time_point queued;
+    };
+
+    // orders the publish queue earliest-deadline-first, then by submission order
+    struct PublishTaskCompare {
+        bool operator()( const std::shared_ptr<PublishTask>& lhs, const std::shared_ptr<PublishTask>& rhs ) const {
+            return lhs->deadline != rhs->deadline ? lhs->deadline > rhs->deadline : lhs->sequence > rhs->sequence;
+        }
+    };
+
+    // one request of a /batch call and its result
+    struct BatchEntry {
+        std::string path;
+        std::shared_ptr<rapidjson::Document> request;
+        std::shared_ptr<rapidjson::Document> response;
+        int status = 0;
+    };
+
+    // entries of a /batch call; parallel batches start every entry without waiting for the previous one to complete
+    struct BatchState {
+        std::vector<BatchEntry> entries;
+        bool parallel = false;
+        std::atomic<size_t> next{ 0 };
+        std::atomic<size_t> remaining{ 0 };
+        std::shared_ptr<RequestCompletion> completion;
+    };
+
+    using SubscriptionList = std::vector<std::pair<TopicHandle, std::shared_ptr<Subscriber>>>;
+
+    // number of response statuses tracked separately per route, including one slot for any other status
+    static const size_t ROUTE_STATUS_SLOTS = 6;
+
+    // request timings of one route, in microseconds
+    struct RouteMetrics {
+        // from arrival until a handler thread picked the request up
+        LatencyHistogram queueWait;
+        // time spent in the handler call itself
+        LatencyHistogram run;
+        // from arrival until the response was sent, per response status
+        LatencyHistogram total[ ROUTE_STATUS_SLOTS ];
+    };
+
+    static size_t getStatusSlot( int status );
+
+    // queued handler invocations record their timings into the route metrics
+    friend struct HandlerTask;
+    friend struct HttpCompletion;
+
+    struct Route {
+        // shared with queued requests, so dispatching one copies a pointer instead of the handler
+        std::shared_ptr<const AsyncRequestHandler> handler;
+        // default request deadline, zero for none
+        std::chrono::milliseconds timeout;
+        std::shared_ptr<RouteMetrics> metrics;
+    };
+
+    void handleRequest( std::shared_ptr<HttpRequest> request );
+
+    bool readSubscriptions();
+    void loadSubscriptions( const std::vector<std::pair<std::string, std::shared_ptr<Subscriber>>>& subscriptions );
+    bool writeSubscriptions();
+    // the persisted form of the remote subscriptions, an array of { id, endpoint, path }; called with m_subscriptionMutex held
+    std::string serializeSubscriptions();
+    void probeSubscribers();
+    void stopStartupThread();
+    bool addSubscription( const TopicHandle& topic, std::shared_ptr<Subscriber> subscriber );
+    bool removeSubscription( const TopicHandle& topic, std::shared_ptr<Subscriber> subscriber );
+    bool addSubscriptions( const SubscriptionList& subscriptions );
+    // with @c deadOnly, a subscription is kept unless the subscriber in the topic is still DEAD
+    bool removeSubscriptions( const SubscriptionList& subscriptions, bool deadOnly = false );
+    SubscriptionList parseSubscriptions( const rapidjson::Value& request );
+    std::shared_ptr<PublishTask> createPublishTask( const TopicHandle& topic, std::shared_ptr<Subscriber> subscriber );
+    bool publish( const TopicHandle& topic, std::shared_ptr<rapidjson::Document> message, std::shared_ptr<const std::string> payload, std::chrono::steady_clock::time_point deadline, std::shared_ptr<CollectState> collect = nullptr );
+    void schedulePublishTask( std::shared_ptr<PublishTask> task );
+    void schedulePublishTasks( std::vector<std::shared_ptr<PublishTask>> tasks );
+    void submitPublishDrain();
+    void drainPublishQueue();
+    bool publishMessageToSubscriber( std::shared_ptr<PublishTask> task );
+    bool publishMessageToLocalSubscriber( std::shared_ptr<PublishTask> task );
+    void completePublishTask( std::shared_ptr<PublishTask> task, SubscriberResponse::Status status, long httpStatus, std::shared_ptr<rapidjson::Document> response );
+    void resolveCollect( std::shared_ptr<CollectState> state, bool complete );
+    void dispatchStandbyTask( std::shared_ptr<CollectState> state );
+    void runRequestTask( const std::shared_ptr<PublishTask>& task );
+    bool submitLocalPublishTask( const std::shared_ptr<PublishTask>& task );
+    void runLocalPublishTask( const std::shared_ptr<PublishTask>& task );
+
+    bool subscribeHandler( std::shared_ptr<rapidjson::Document> request, std::shared_ptr<rapidjson::Document> response );
+    bool unsubscribeHandler( std::shared_ptr<rapidjson::Document> request, std::shared_ptr<rapidjson::Document> response );
+    void batchHandler( std::shared_ptr<rapidjson::Document> request, std::shared_ptr<RequestCompletion> completion );
+    void runBatchEntries( std::shared_ptr<BatchState> state );
+    void dispatchBatchEntry( std::shared_ptr<BatchState> state, size_t index );
+    void finishBatch( std::shared_ptr<BatchState> state );
+    void buildMetrics( rapidjson::Document& document );
+    void capturePublish( const TopicHandle& topic, const std::shared_ptr<rapidjson::Document>& message, const std::shared_ptr<const std::string>& payload );
+
+private:
+    std::shared_ptr<HttpServer> m_server;
+    std::shared_ptr<aace::engine::storage::LocalStorageInterface> m_localStorage;
+    // opt-in recording of the handled traffic
+    TrafficCapture m_capture;
+
+    std::unordered_map<std::string, Route> m_requestHandlers;
+    InstrumentedMutex m_handlerMutex;
+
+    // guards the topic registry and serializes writes of the persisted subscriptions; taken before any Topic::m_mutex
+    std::unordered_map<std::string, TopicHandle> m_topics;
+    InstrumentedMutex m_subscriptionMutex;
+
+    // after start() the persisted subscriptions are read and their endpoints probed in the background;
+    // writes wait until the subscriptions are all loaded
+    std::thread m_startupThread;
+    bool m_subscriptionsLoaded;
+    bool m_subscriptionsDirty;
+    // subscriptions removed during the load, so their persisted entries are not added back
+    std::unordered_set<std::string> m_removedWhileLoading;
+
+    // endpoints that are not listening are probed again every m_probeInterval and dropped once m_probeGracePeriod has passed
+    std::chrono::milliseconds m_probeInterval;
+    std::chrono::milliseconds m_probeGracePeriod;
+    // wakes the probe loop early when the service stops
+    bool m_startupStopping;
+    std::mutex m_startupMutex;
+    std::condition_variable m_startupCondition;
+
+    std::priority_queue<std::shared_ptr<PublishTask>, std::vector<std::shared_ptr<PublishTask>>, PublishTaskCompare> m_publishQueue;
+    uint64_t m_publishSequence;
+    // true while a drainPublishQueue() job is queued or running
+    bool m_publishDrainScheduled;
+    std::mutex m_publishQueueMutex;
+
+    TimerQueue m_timerQueue;
+
+    TaskExecutor m_handlerExecutor;
+    TaskExecutor m_publishExecutor;
+
+    // request/reply deliveries run on several workers so a hedge never queues behind the request it is hedging
+    TaskExecutor m_requestExecutor;
+
+    // in-process subscribers are called on their own worker, never behind a blocking remote delivery
+    TaskExecutor m_localExecutor;
+};
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
+
+#endif // AACE_ENGINE_LOCAL_SKILL_SERVICE_LOCAL_SKILL_SERVICE_ENGINE_SERVICE_H
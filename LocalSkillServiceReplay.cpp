@@ -0,0 +1,427 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Replays a traffic capture written by the service (lssCaptureFile) against a fresh standalone service
+// and reports the latency distribution, e.g.
+//
+//     LocalSkillServiceReplay --capture=incident.lsscap --speed=4 --stub-subscribers --output=replay.json
+//
+// Requests to routes the fresh service does not have are answered by an echo handler. With
+// --stub-subscribers the endpoints of replayed subscriptions are replaced by local stub subscribers.
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <rapidjson/document.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "AACE/Engine/LocalSkillService/LocalSkillServiceEngineService.h"
+#include "AACE/Engine/LocalSkillService/LatencyHistogram.h"
+#include "AACE/Engine/LocalSkillService/ToolSupport.h"
+#include "AACE/Engine/LocalSkillService/TrafficCapture.h"
+
+using namespace aace::engine::localSkillService;
+using namespace aace::engine::localSkillService::tools;
+
+namespace {
+
+struct Options {
+    std::string capture;
+    // 0 replays as fast as possible
+    double speed = 1.0;
+    size_t concurrency = 16;
+    bool stubSubscribers = false;
+    std::chrono::milliseconds publishTimeout{ 2000 };
+    std::string output;
+};
+
+bool parseOptions( int argc, char** argv, Options& options ) {
+    for ( int index = 1; index < argc; index++ ) {
+        std::string arg = argv[index];
+        if ( arg == "--stub-subscribers" ) {
+            options.stubSubscribers = true;
+            continue;
+        }
+        auto split = arg.find( '=' );
+        if ( arg.compare( 0, 2, "--" ) != 0 || split == std::string::npos ) {
+            return false;
+        }
+        auto name = arg.substr( 2, split - 2 );
+        auto value = arg.substr( split + 1 );
+        if ( name == "capture" ) {
+            options.capture = value;
+        }
+        else if ( name == "speed" ) {
+            options.speed = value == "max" ? 0.0 : std::strtod( value.c_str(), nullptr );
+            if ( options.speed < 0 ) {
+                return false;
+            }
+        }
+        else if ( name == "concurrency" ) {
+            options.concurrency = std::max<size_t>( 1, std::strtoull( value.c_str(), nullptr, 10 ) );
+        }
+        else if ( name == "publish-timeout-ms" ) {
+            options.publishTimeout = std::chrono::milliseconds( std::strtoll( value.c_str(), nullptr, 10 ) );
+        }
+        else if ( name == "output" ) {
+            options.output = value;
+        }
+        else {
+            return false;
+        }
+    }
+    return !options.capture.empty();
+}
+
+// splits "METHOD /path" as written by TrafficCapture::recordRequest()
+void splitRequestName( const std::string& name, std::string& method, std::string& path ) {
+    auto split = name.find( ' ' );
+    method = name.substr( 0, split );
+    path = split != std::string::npos ? name.substr( split + 1 ) : "/";
+}
+
+// maps the endpoints of captured subscriptions onto local stub subscribers
+class EndpointRewriter {
+public:
+    EndpointRewriter( StubSubscribers& subscribers ) : m_subscribers( subscribers ) {}
+
+    std::string rewrite( const std::string& body ) {
+        rapidjson::Document document;
+        if ( document.Parse( body.c_str(), body.size() ).HasParseError() ) {
+            return body;
+        }
+        if ( document.IsArray() ) {
+            for ( auto& item : document.GetArray() ) {
+                rewriteItem( item, document.GetAllocator() );
+            }
+        }
+        else {
+            rewriteItem( document, document.GetAllocator() );
+        }
+        rapidjson::StringBuffer sb;
+        rapidjson::Writer<rapidjson::StringBuffer> writer( sb );
+        document.Accept( writer );
+        return std::string( sb.GetString(), sb.GetSize() );
+    }
+
+private:
+    void rewriteItem( rapidjson::Value& item, rapidjson::Document::AllocatorType& allocator ) {
+        if ( !item.IsObject() || !item.HasMember( "endpoint" ) || !item["endpoint"].IsString() ) {
+            return;
+        }
+        auto& stub = m_endpoints[ item["endpoint"].GetString() ];
+        if ( stub.empty() ) {
+            stub = m_subscribers.add( StubSubscribers::Kind::HEALTHY );
+        }
+        item["endpoint"].SetString( stub.c_str(), static_cast<rapidjson::SizeType>( stub.size() ), allocator );
+    }
+
+    StubSubscribers& m_subscribers;
+    std::map<std::string, std::string> m_endpoints;
+};
+
+// a captured request waiting for a client connection
+struct PendingRequest {
+    const TrafficRecord* record;
+    std::chrono::steady_clock::time_point due;
+};
+
+class RequestClients {
+public:
+    RequestClients( const std::string& socketPath, size_t count, std::map<std::string, std::unique_ptr<LatencyHistogram>>& pathLatency ) :
+        m_socketPath( socketPath ),
+        m_pathLatency( pathLatency ),
+        m_errors( 0 ),
+        m_done( false ) {
+        for ( size_t index = 0; index < count; index++ ) {
+            m_threads.emplace_back( &RequestClients::run, this );
+        }
+    }
+
+    void submit( const TrafficRecord* record, std::chrono::steady_clock::time_point due ) {
+        {
+            std::lock_guard<std::mutex> guard( m_mutex );
+            m_queue.push_back( PendingRequest{ record, due } );
+        }
+        m_cv.notify_one();
+    }
+
+    // waits for every submitted request to be answered
+    void finish() {
+        {
+            std::lock_guard<std::mutex> guard( m_mutex );
+            m_done = true;
+        }
+        m_cv.notify_all();
+        for ( auto& thread : m_threads ) {
+            thread.join();
+        }
+    }
+
+    LatencyHistogram& getLatency() { return m_latency; }
+    LatencyHistogram& getQueueDelay() { return m_queueDelay; }
+    uint64_t getErrors() const { return m_errors; }
+
+private:
+    void run() {
+        HttpClient client;
+        bool connected = client.connect( m_socketPath );
+        std::string method;
+        std::string path;
+        for ( ;; ) {
+            PendingRequest pending;
+            {
+                std::unique_lock<std::mutex> lock( m_mutex );
+                m_cv.wait( lock, [this] { return m_done || !m_queue.empty(); } );
+                if ( m_queue.empty() ) {
+                    return;
+                }
+                pending = m_queue.front();
+                m_queue.pop_front();
+            }
+            splitRequestName( pending.record->name, method, path );
+            auto sent = std::chrono::steady_clock::now();
+            // time the request waited for a free client after it was due
+            m_queueDelay.record( std::chrono::duration_cast<std::chrono::microseconds>( sent - pending.due ) );
+            int status = connected ? client.request( method, path, pending.record->body ) : 0;
+            if ( status == 0 ) {
+                // the server closes connections at its request limit; retry once on a new one
+                connected = client.connect( m_socketPath );
+                status = connected ? client.request( method, path, pending.record->body ) : 0;
+            }
+            auto latency = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - sent );
+            m_latency.record( latency );
+            m_pathLatency[ path ]->record( latency );
+            if ( status < 200 || status >= 300 ) {
+                m_errors++;
+            }
+        }
+    }
+
+    std::string m_socketPath;
+    std::map<std::string, std::unique_ptr<LatencyHistogram>>& m_pathLatency;
+    LatencyHistogram m_latency;
+    LatencyHistogram m_queueDelay;
+    std::atomic<uint64_t> m_errors;
+    std::deque<PendingRequest> m_queue;
+    bool m_done;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<std::thread> m_threads;
+};
+
+void writeReport( const rapidjson::Document& report, const std::string& output ) {
+    rapidjson::StringBuffer sb;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer( sb );
+    report.Accept( writer );
+    if ( output.empty() ) {
+        std::cout << sb.GetString() << std::endl;
+        return;
+    }
+    FILE* file = fopen( output.c_str(), "w" );
+    if ( file == nullptr ) {
+        std::cerr << "cannot write " << output << std::endl;
+        return;
+    }
+    fputs( sb.GetString(), file );
+    fclose( file );
+}
+
+} // namespace
+
+int main( int argc, char** argv ) {
+    Options options;
+    if ( !parseOptions( argc, argv, options ) ) {
+        std::cerr << "usage: " << argv[0] << " --capture=file [--speed=1|N|max] [--concurrency=16] [--stub-subscribers] [--publish-timeout-ms=2000] [--output=file]" << std::endl;
+        return 2;
+    }
+
+    std::vector<TrafficRecord> records;
+    {
+        TrafficReader reader;
+        if ( !reader.open( options.capture ) ) {
+            std::cerr << "cannot read " << options.capture << std::endl;
+            return 1;
+        }
+        TrafficRecord record;
+        while ( reader.next( record ) ) {
+            records.push_back( record );
+        }
+    }
+
+    char directoryTemplate[] = "/tmp/lss-replay-XXXXXX";
+    if ( mkdtemp( directoryTemplate ) == nullptr ) {
+        std::cerr << "cannot create socket directory: " << std::strerror( errno ) << std::endl;
+        return 1;
+    }
+    std::string directory = directoryTemplate;
+    std::string socketPath = directory + "/lss.sock";
+
+    auto configuration = std::make_shared<std::stringstream>( "{\"lssSocketPath\":\"" + socketPath + "\"}" );
+    auto service = LocalSkillServiceEngineService::createStandalone( configuration, std::make_shared<MemoryStorage>() );
+    if ( !service ) {
+        std::cerr << "cannot start the service" << std::endl;
+        return 1;
+    }
+
+    // routes that belonged to other engine components echo the request; topics are registered up front
+    static const std::set<std::string> BUILTIN_ROUTES = { "/subscribe", "/unsubscribe", "/batch", "/metrics" };
+    std::map<std::string, std::unique_ptr<LatencyHistogram>> pathLatency;
+    std::map<std::string, TopicHandle> topics;
+    std::unique_ptr<StubSubscribers> subscribers( new StubSubscribers( directory, std::chrono::milliseconds( 0 ) ) );
+    EndpointRewriter rewriter( *subscribers );
+    std::string method;
+    std::string path;
+    for ( auto& record : records ) {
+        if ( record.type == TrafficRecord::Type::REQUEST ) {
+            splitRequestName( record.name, method, path );
+            if ( !pathLatency[ path ] ) {
+                pathLatency[ path ].reset( new LatencyHistogram() );
+                if ( BUILTIN_ROUTES.count( path ) == 0 ) {
+                    service->registerHandler( path, []( std::shared_ptr<rapidjson::Document> request, std::shared_ptr<rapidjson::Document> response ) -> bool {
+                        if ( request && request->IsObject() ) {
+                            response->CopyFrom( *request, response->GetAllocator() );
+                        }
+                        return true;
+                    } );
+                }
+            }
+            if ( options.stubSubscribers && ( path == "/subscribe" || path == "/unsubscribe" ) ) {
+                record.body = rewriter.rewrite( record.body );
+            }
+        }
+        else if ( record.type == TrafficRecord::Type::PUBLISH && topics.count( record.name ) == 0 ) {
+            topics[ record.name ] = service->registerTopic( record.name );
+        }
+    }
+
+    RequestClients clients( socketPath, options.concurrency, pathLatency );
+    std::vector<std::future<PublishResult>> publishes;
+    LatencyHistogram scheduleLag;
+    auto start = std::chrono::steady_clock::now();
+    for ( auto& record : records ) {
+        auto due = start;
+        if ( options.speed > 0 ) {
+            due += std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double, std::micro>( record.offset.count() / options.speed ) );
+            std::this_thread::sleep_until( due );
+        }
+        auto now = std::chrono::steady_clock::now();
+        scheduleLag.record( std::chrono::duration_cast<std::chrono::microseconds>( now - std::max( due, start ) ) );
+        if ( record.type == TrafficRecord::Type::REQUEST ) {
+            clients.submit( &record, now );
+        }
+        else if ( record.type == TrafficRecord::Type::PUBLISH ) {
+            std::shared_ptr<rapidjson::Document> message = nullptr;
+            if ( !record.body.empty() ) {
+                message = std::make_shared<rapidjson::Document>();
+                if ( message->Parse( record.body.c_str(), record.body.size() ).HasParseError() ) {
+                    message = nullptr;
+                }
+            }
+            publishes.push_back( service->publishAndCollect( topics[ record.name ], message, options.publishTimeout ) );
+        }
+    }
+    clients.finish();
+
+    // publish latency is the slowest successful delivery of each publish; publishes that reached nobody
+    // are counted separately so they do not pull the percentiles down
+    LatencyHistogram publishLatency;
+    uint64_t delivered = 0;
+    uint64_t failed = 0;
+    uint64_t undelivered = 0;
+    for ( auto& future : publishes ) {
+        auto result = future.get();
+        std::chrono::milliseconds slowest( 0 );
+        bool reached = false;
+        for ( auto& response : result.responses ) {
+            if ( response.status == SubscriberResponse::Status::SUCCESS ) {
+                delivered++;
+                reached = true;
+                slowest = std::max( slowest, response.latency );
+            }
+            else {
+                failed++;
+            }
+        }
+        if ( reached ) {
+            publishLatency.record( slowest );
+        }
+        else {
+            undelivered++;
+        }
+    }
+    auto elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    rapidjson::Document report( rapidjson::kObjectType );
+    auto& allocator = report.GetAllocator();
+    report.AddMember( "capture", rapidjson::Value( options.capture, allocator ), allocator );
+    report.AddMember( "speed", options.speed, allocator );
+    report.AddMember( "records", static_cast<uint64_t>( records.size() ), allocator );
+    report.AddMember( "capturedSeconds", records.empty() ? 0.0 : records.back().offset.count() / 1e6, allocator );
+    report.AddMember( "replaySeconds", elapsed, allocator );
+    report.AddMember( "scheduleLagUs", scheduleLag.toJson( allocator ), allocator );
+
+    rapidjson::Value requests( rapidjson::kObjectType );
+    requests.AddMember( "count", clients.getLatency().getCount(), allocator );
+    requests.AddMember( "errors", clients.getErrors(), allocator );
+    requests.AddMember( "latencyUs", clients.getLatency().toJson( allocator ), allocator );
+    requests.AddMember( "clientWaitUs", clients.getQueueDelay().toJson( allocator ), allocator );
+    rapidjson::Value byPath( rapidjson::kObjectType );
+    for ( auto& pair : pathLatency ) {
+        rapidjson::Value key( pair.first, allocator );
+        rapidjson::Value histogram = pair.second->toJson( allocator );
+        byPath.AddMember( key, histogram, allocator );
+    }
+    requests.AddMember( "byPath", byPath, allocator );
+    report.AddMember( "requests", requests, allocator );
+
+    rapidjson::Value publishReport( rapidjson::kObjectType );
+    publishReport.AddMember( "count", static_cast<uint64_t>( publishes.size() ), allocator );
+    publishReport.AddMember( "undelivered", undelivered, allocator );
+    publishReport.AddMember( "delivered", delivered, allocator );
+    publishReport.AddMember( "failed", failed, allocator );
+    publishReport.AddMember( "latencyUs", publishLatency.toJson( allocator ), allocator );
+    report.AddMember( "publishes", publishReport, allocator );
+
+    auto metrics = service->getMetrics();
+    report.AddMember( "serviceMetrics", rapidjson::Value( *metrics, allocator ), allocator );
+    writeReport( report, options.output );
+
+    // the servers remove their sockets when they stop
+    service.reset();
+    subscribers.reset();
+    rmdir( directory.c_str() );
+    return 0;
+}
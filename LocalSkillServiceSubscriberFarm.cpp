@@ -0,0 +1,616 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Mock subscriber farm for load and soak tests of the publish path. Runs N stub subscribers on one
+// epoll event loop, subscribes them to a topic through the service's /subscribe route and reports what
+// each one received, e.g.
+//
+//     LocalSkillServiceSubscriberFarm --lss-socket=/tmp/lss.sock --topic=weather --count=200 --latency=exp:20
+//         --error-rate=0.01 --refusal-rate=0.001 --payload=512 --duration-s=600
+//
+// Latency is fixed:MS, uniform:MIN:MAX or exp:MEAN. A refused delivery is accepted and closed without a
+// response, since a listening UNIX socket cannot refuse individual connections. Gaps are missing values
+// of the numeric sequence field (--sequence-field) in consecutive deliveries to one subscriber.
+//
+// The service drops a subscriber after a failed delivery, so a subscriber that answered with an injected error
+// or refusal subscribes again after --resubscribe-delay-ms (default 250, negative to never), which keeps the
+// fan-out constant over a soak run. The report shows how often each one resubscribed and when it last received.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <rapidjson/document.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "AACE/Engine/LocalSkillService/ToolSupport.h"
+
+using namespace aace::engine::localSkillService::tools;
+
+namespace {
+
+std::atomic<bool> s_stopping( false );
+
+void onSignal( int ) {
+    s_stopping = true;
+}
+
+struct LatencyModel {
+    enum class Kind { FIXED, UNIFORM, EXPONENTIAL };
+    Kind kind = Kind::FIXED;
+    double first = 0;
+    double second = 0;
+
+    bool parse( const std::string& spec ) {
+        std::vector<std::string> parts;
+        std::stringstream ss( spec );
+        std::string part;
+        while ( std::getline( ss, part, ':' ) ) {
+            parts.push_back( part );
+        }
+        if ( parts.size() == 2 && parts[0] == "fixed" ) {
+            kind = Kind::FIXED;
+        }
+        else if ( parts.size() == 3 && parts[0] == "uniform" ) {
+            kind = Kind::UNIFORM;
+            second = std::strtod( parts[2].c_str(), nullptr );
+        }
+        else if ( parts.size() == 2 && parts[0] == "exp" ) {
+            kind = Kind::EXPONENTIAL;
+        }
+        else {
+            return false;
+        }
+        first = std::strtod( parts[1].c_str(), nullptr );
+        return first >= 0 && second >= 0;
+    }
+
+    std::chrono::microseconds sample( std::mt19937& random ) const {
+        double ms = first;
+        if ( kind == Kind::UNIFORM ) {
+            ms = std::uniform_real_distribution<double>( first, std::max( first, second ) )( random );
+        }
+        else if ( kind == Kind::EXPONENTIAL && first > 0 ) {
+            ms = std::exponential_distribution<double>( 1.0 / first )( random );
+        }
+        return std::chrono::microseconds( static_cast<int64_t>( ms * 1000 ) );
+    }
+};
+
+struct Options {
+    std::string lssSocket;
+    std::string topic;
+    size_t count = 10;
+    LatencyModel latency;
+    double errorRate = 0;
+    double refusalRate = 0;
+    size_t payloadSize = 2;
+    std::string sequenceField = "sequence";
+    std::chrono::seconds duration{ 0 };
+    std::chrono::milliseconds resubscribeDelay{ 250 };
+    unsigned seed = 1;
+    std::string output;
+};
+
+bool parseOptions( int argc, char** argv, Options& options ) {
+    for ( int index = 1; index < argc; index++ ) {
+        std::string arg = argv[index];
+        auto split = arg.find( '=' );
+        if ( arg.compare( 0, 2, "--" ) != 0 || split == std::string::npos ) {
+            return false;
+        }
+        auto name = arg.substr( 2, split - 2 );
+        auto value = arg.substr( split + 1 );
+        if ( name == "lss-socket" ) {
+            options.lssSocket = value;
+        }
+        else if ( name == "topic" ) {
+            options.topic = value;
+        }
+        else if ( name == "count" ) {
+            options.count = std::strtoull( value.c_str(), nullptr, 10 );
+        }
+        else if ( name == "latency" ) {
+            if ( !options.latency.parse( value ) ) {
+                return false;
+            }
+        }
+        else if ( name == "error-rate" ) {
+            options.errorRate = std::strtod( value.c_str(), nullptr );
+        }
+        else if ( name == "refusal-rate" ) {
+            options.refusalRate = std::strtod( value.c_str(), nullptr );
+        }
+        else if ( name == "payload" ) {
+            options.payloadSize = std::strtoull( value.c_str(), nullptr, 10 );
+        }
+        else if ( name == "sequence-field" ) {
+            options.sequenceField = value;
+        }
+        else if ( name == "duration-s" ) {
+            options.duration = std::chrono::seconds( std::strtoll( value.c_str(), nullptr, 10 ) );
+        }
+        else if ( name == "resubscribe-delay-ms" ) {
+            options.resubscribeDelay = std::chrono::milliseconds( std::strtoll( value.c_str(), nullptr, 10 ) );
+        }
+        else if ( name == "seed" ) {
+            options.seed = static_cast<unsigned>( std::strtoul( value.c_str(), nullptr, 10 ) );
+        }
+        else if ( name == "output" ) {
+            options.output = value;
+        }
+        else {
+            return false;
+        }
+    }
+    return !options.lssSocket.empty() && !options.topic.empty() && options.count > 0;
+}
+
+struct Subscriber {
+    std::string path;
+    int listenFd = -1;
+    uint64_t received = 0;
+    uint64_t errors = 0;
+    uint64_t refused = 0;
+    uint64_t gaps = 0;
+    uint64_t outOfOrder = 0;
+    uint64_t resubscribed = 0;
+    int64_t lastSequence = -1;
+    std::chrono::steady_clock::time_point lastArrival;
+    // set after an injected failure, until the subscriber subscribes again
+    bool dropped = false;
+    std::chrono::steady_clock::time_point resubscribeAt;
+    std::chrono::microseconds maxInterval{ 0 };
+};
+
+struct Connection {
+    int fd;
+    size_t subscriber;
+    std::string input;
+    std::string output;
+    size_t written = 0;
+    bool responding = false;
+};
+
+// epoll ids below the subscriber count are listening sockets, connections are numbered after them
+class Farm {
+public:
+    Farm( const Options& options, const std::string& directory ) :
+        m_options( options ),
+        m_directory( directory ),
+        m_random( options.seed ),
+        m_epollFd( -1 ),
+        m_nextConnectionId( options.count ) {
+        std::string data( options.payloadSize > 12 ? options.payloadSize - 12 : 0, 'x' );
+        m_responseBody = options.payloadSize >= 12 ? "{\"data\":\"" + data + "\"}" : "{}";
+    }
+
+    ~Farm() {
+        for ( auto& pair : m_connections ) {
+            close( pair.second->fd );
+        }
+        for ( auto& subscriber : m_subscribers ) {
+            if ( subscriber.listenFd >= 0 ) {
+                close( subscriber.listenFd );
+                unlink( subscriber.path.c_str() );
+            }
+        }
+        if ( m_epollFd >= 0 ) {
+            close( m_epollFd );
+        }
+    }
+
+    bool start() {
+        m_epollFd = epoll_create1( EPOLL_CLOEXEC );
+        if ( m_epollFd < 0 ) {
+            return false;
+        }
+        m_subscribers.resize( m_options.count );
+        for ( size_t index = 0; index < m_subscribers.size(); index++ ) {
+            auto& subscriber = m_subscribers[ index ];
+            subscriber.path = m_directory + "/subscriber-" + std::to_string( index ) + ".sock";
+            subscriber.listenFd = socket( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 );
+            sockaddr_un address;
+            std::memset( &address, 0, sizeof( address ) );
+            address.sun_family = AF_UNIX;
+            std::strncpy( address.sun_path, subscriber.path.c_str(), sizeof( address.sun_path ) - 1 );
+            if ( subscriber.listenFd < 0 || bind( subscriber.listenFd, reinterpret_cast<sockaddr*>( &address ), sizeof( address ) ) < 0 || listen( subscriber.listenFd, 128 ) < 0 ) {
+                std::cerr << "cannot listen on " << subscriber.path << ": " << std::strerror( errno ) << std::endl;
+                return false;
+            }
+            if ( !watch( subscriber.listenFd, index, EPOLLIN, EPOLL_CTL_ADD ) ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // subscribes or unsubscribes every stub subscriber in a single call
+    bool registerAll( const std::string& route ) {
+        std::vector<size_t> indexes( m_subscribers.size() );
+        for ( size_t index = 0; index < indexes.size(); index++ ) {
+            indexes[ index ] = index;
+        }
+        return registerSubscribers( route, indexes );
+    }
+
+    bool registerSubscribers( const std::string& route, const std::vector<size_t>& indexes ) {
+        rapidjson::Document request( rapidjson::kArrayType );
+        auto& allocator = request.GetAllocator();
+        for ( auto index : indexes ) {
+            auto& subscriber = m_subscribers[ index ];
+            rapidjson::Value item( rapidjson::kObjectType );
+            item.AddMember( "id", rapidjson::Value( m_options.topic, allocator ), allocator );
+            item.AddMember( "endpoint", rapidjson::Value( subscriber.path, allocator ), allocator );
+            item.AddMember( "path", "/deliver", allocator );
+            request.PushBack( item, allocator );
+        }
+        rapidjson::StringBuffer sb;
+        rapidjson::Writer<rapidjson::StringBuffer> writer( sb );
+        request.Accept( writer );
+        HttpClient client;
+        if ( !client.connect( m_options.lssSocket ) ) {
+            std::cerr << "cannot connect to " << m_options.lssSocket << std::endl;
+            return false;
+        }
+        auto status = client.request( "POST", route, std::string( sb.GetString(), sb.GetSize() ) );
+        if ( status < 200 || status >= 300 ) {
+            std::cerr << route << " failed with status " << status << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void run() {
+        m_started = std::chrono::steady_clock::now();
+        auto end = m_options.duration.count() > 0 ? m_started + m_options.duration : std::chrono::steady_clock::time_point::max();
+        epoll_event events[64];
+        while ( !s_stopping && std::chrono::steady_clock::now() < end ) {
+            // wake up for the next delayed response, and at least every 100ms to notice a stop
+            int timeout = 100;
+            if ( !m_timers.empty() ) {
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>( m_timers.top().first - std::chrono::steady_clock::now() ).count();
+                timeout = static_cast<int>( std::max<int64_t>( 0, std::min<int64_t>( timeout, wait ) ) );
+            }
+            int count = epoll_wait( m_epollFd, events, 64, timeout );
+            for ( int index = 0; index < count; index++ ) {
+                auto id = events[index].data.u64;
+                if ( id < m_subscribers.size() ) {
+                    accept( id );
+                }
+                else if ( events[index].events & ( EPOLLERR | EPOLLHUP ) ) {
+                    closeConnection( id );
+                }
+                else if ( events[index].events & EPOLLOUT ) {
+                    flush( id );
+                }
+                else if ( events[index].events & EPOLLIN ) {
+                    read( id );
+                }
+            }
+            auto now = std::chrono::steady_clock::now();
+            while ( !m_timers.empty() && m_timers.top().first <= now ) {
+                auto id = m_timers.top().second;
+                m_timers.pop();
+                flush( id );
+            }
+            resubscribe( now );
+        }
+    }
+
+    void report( rapidjson::Document& document ) {
+        document.SetObject();
+        auto& allocator = document.GetAllocator();
+        uint64_t received = 0;
+        uint64_t errors = 0;
+        uint64_t refused = 0;
+        uint64_t gaps = 0;
+        uint64_t resubscribed = 0;
+        rapidjson::Value subscribers( rapidjson::kArrayType );
+        for ( auto& subscriber : m_subscribers ) {
+            rapidjson::Value item( rapidjson::kObjectType );
+            item.AddMember( "endpoint", rapidjson::Value( subscriber.path, allocator ), allocator );
+            item.AddMember( "received", subscriber.received, allocator );
+            item.AddMember( "errors", subscriber.errors, allocator );
+            item.AddMember( "refused", subscriber.refused, allocator );
+            item.AddMember( "sequenceGaps", subscriber.gaps, allocator );
+            item.AddMember( "outOfOrder", subscriber.outOfOrder, allocator );
+            item.AddMember( "maxIntervalMs", subscriber.maxInterval.count() / 1000.0, allocator );
+            item.AddMember( "resubscribed", subscriber.resubscribed, allocator );
+            // when the subscriber last received a message, in ms since the farm started, or -1 if it never did
+            double lastReceived = subscriber.received > 0 ? std::chrono::duration_cast<std::chrono::microseconds>( subscriber.lastArrival - m_started ).count() / 1000.0 : -1.0;
+            item.AddMember( "lastReceivedMs", lastReceived, allocator );
+            item.AddMember( "subscribed", !subscriber.dropped, allocator );
+            subscribers.PushBack( item, allocator );
+            received += subscriber.received;
+            errors += subscriber.errors;
+            refused += subscriber.refused;
+            gaps += subscriber.gaps;
+            resubscribed += subscriber.resubscribed;
+        }
+        document.AddMember( "topic", rapidjson::Value( m_options.topic, allocator ), allocator );
+        document.AddMember( "subscribers", static_cast<uint64_t>( m_subscribers.size() ), allocator );
+        document.AddMember( "received", received, allocator );
+        document.AddMember( "errors", errors, allocator );
+        document.AddMember( "refused", refused, allocator );
+        document.AddMember( "sequenceGaps", gaps, allocator );
+        document.AddMember( "resubscribed", resubscribed, allocator );
+        document.AddMember( "perSubscriber", subscribers, allocator );
+    }
+
+private:
+    bool watch( int fd, uint64_t id, uint32_t events, int operation ) {
+        epoll_event event;
+        std::memset( &event, 0, sizeof( event ) );
+        event.events = events;
+        event.data.u64 = id;
+        return epoll_ctl( m_epollFd, operation, fd, &event ) == 0;
+    }
+
+    // the service removes a subscriber whose delivery failed
+    void drop( size_t index ) {
+        auto& subscriber = m_subscribers[ index ];
+        if ( m_options.resubscribeDelay.count() < 0 || subscriber.dropped ) {
+            return;
+        }
+        subscriber.dropped = true;
+        // waiting lets the removal land first, otherwise it would undo the new subscription
+        subscriber.resubscribeAt = std::chrono::steady_clock::now() + m_options.resubscribeDelay;
+        m_dropped.push_back( index );
+    }
+
+    void resubscribe( std::chrono::steady_clock::time_point now ) {
+        std::vector<size_t> due;
+        std::vector<size_t> waiting;
+        for ( auto index : m_dropped ) {
+            ( m_subscribers[ index ].resubscribeAt <= now ? due : waiting ).push_back( index );
+        }
+        if ( due.empty() ) {
+            return;
+        }
+        m_dropped.swap( waiting );
+        if ( !registerSubscribers( "/subscribe", due ) ) {
+            // try again after another delay
+            for ( auto index : due ) {
+                m_subscribers[ index ].resubscribeAt = now + m_options.resubscribeDelay;
+                m_dropped.push_back( index );
+            }
+            return;
+        }
+        for ( auto index : due ) {
+            m_subscribers[ index ].dropped = false;
+            m_subscribers[ index ].resubscribed++;
+        }
+    }
+
+    bool chance( double rate ) {
+        return rate > 0 && std::uniform_real_distribution<double>( 0, 1 )( m_random ) < rate;
+    }
+
+    void accept( size_t index ) {
+        auto& subscriber = m_subscribers[ index ];
+        for ( ;; ) {
+            int fd = accept4( subscriber.listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC );
+            if ( fd < 0 ) {
+                return;
+            }
+            if ( chance( m_options.refusalRate ) ) {
+                subscriber.refused++;
+                close( fd );
+                drop( index );
+                continue;
+            }
+            auto id = m_nextConnectionId++;
+            if ( !watch( fd, id, EPOLLIN, EPOLL_CTL_ADD ) ) {
+                close( fd );
+                continue;
+            }
+            std::unique_ptr<Connection> connection( new Connection() );
+            connection->fd = fd;
+            connection->subscriber = index;
+            m_connections.emplace( id, std::move( connection ) );
+        }
+    }
+
+    void read( uint64_t id ) {
+        auto it = m_connections.find( id );
+        if ( it == m_connections.end() ) {
+            return;
+        }
+        auto& connection = *it->second;
+        char buffer[16384];
+        for ( ;; ) {
+            auto count = recv( connection.fd, buffer, sizeof( buffer ), 0 );
+            if ( count > 0 ) {
+                connection.input.append( buffer, count );
+                continue;
+            }
+            if ( count == 0 || ( errno != EAGAIN && errno != EWOULDBLOCK ) ) {
+                closeConnection( id );
+                return;
+            }
+            break;
+        }
+        if ( connection.responding ) {
+            return;
+        }
+        auto headerEnd = connection.input.find( "\r\n\r\n" );
+        if ( headerEnd == std::string::npos ) {
+            return;
+        }
+        size_t length = 0;
+        auto header = connection.input.find( "Content-Length:" );
+        if ( header == std::string::npos ) {
+            header = connection.input.find( "content-length:" );
+        }
+        if ( header != std::string::npos && header < headerEnd ) {
+            length = std::strtoull( connection.input.c_str() + header + 15, nullptr, 10 );
+        }
+        if ( connection.input.size() < headerEnd + 4 + length ) {
+            return;
+        }
+        deliver( connection, connection.input.substr( headerEnd + 4, length ) );
+        // the response is written once its sampled latency has passed
+        m_timers.emplace( std::chrono::steady_clock::now() + m_options.latency.sample( m_random ), id );
+    }
+
+    void deliver( Connection& connection, const std::string& body ) {
+        auto& subscriber = m_subscribers[ connection.subscriber ];
+        auto now = std::chrono::steady_clock::now();
+        if ( subscriber.received > 0 ) {
+            subscriber.maxInterval = std::max( subscriber.maxInterval, std::chrono::duration_cast<std::chrono::microseconds>( now - subscriber.lastArrival ) );
+        }
+        subscriber.lastArrival = now;
+        subscriber.received++;
+
+        rapidjson::Document message;
+        if ( !message.Parse( body.c_str(), body.size() ).HasParseError() && message.IsObject() ) {
+            auto field = message.FindMember( m_options.sequenceField.c_str() );
+            if ( field != message.MemberEnd() && field->value.IsInt64() ) {
+                auto sequence = field->value.GetInt64();
+                if ( subscriber.lastSequence >= 0 && sequence > subscriber.lastSequence + 1 ) {
+                    subscriber.gaps += sequence - subscriber.lastSequence - 1;
+                }
+                else if ( subscriber.lastSequence >= 0 && sequence <= subscriber.lastSequence ) {
+                    subscriber.outOfOrder++;
+                }
+                subscriber.lastSequence = std::max( subscriber.lastSequence, sequence );
+            }
+        }
+
+        std::string status = "200 OK";
+        std::string responseBody = m_responseBody;
+        if ( chance( m_options.errorRate ) ) {
+            subscriber.errors++;
+            drop( connection.subscriber );
+            status = "500 Internal Server Error";
+            responseBody.clear();
+        }
+        connection.output = "HTTP/1.1 " + status + "\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string( responseBody.size() ) + "\r\nConnection: close\r\n\r\n" + responseBody;
+        connection.responding = true;
+    }
+
+    void flush( uint64_t id ) {
+        auto it = m_connections.find( id );
+        if ( it == m_connections.end() ) {
+            return;
+        }
+        auto& connection = *it->second;
+        while ( connection.written < connection.output.size() ) {
+            auto count = send( connection.fd, connection.output.data() + connection.written, connection.output.size() - connection.written, MSG_NOSIGNAL );
+            if ( count < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK ) ) {
+                watch( connection.fd, id, EPOLLIN | EPOLLOUT, EPOLL_CTL_MOD );
+                return;
+            }
+            if ( count <= 0 ) {
+                break;
+            }
+            connection.written += count;
+        }
+        closeConnection( id );
+    }
+
+    void closeConnection( uint64_t id ) {
+        auto it = m_connections.find( id );
+        if ( it == m_connections.end() ) {
+            return;
+        }
+        close( it->second->fd );
+        m_connections.erase( it );
+    }
+
+    const Options& m_options;
+    std::string m_directory;
+    std::string m_responseBody;
+    std::mt19937 m_random;
+    int m_epollFd;
+    uint64_t m_nextConnectionId;
+    std::vector<Subscriber> m_subscribers;
+    // subscribers waiting to subscribe again after an injected failure
+    std::vector<size_t> m_dropped;
+    std::chrono::steady_clock::time_point m_started;
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> m_connections;
+    using Timer = std::pair<std::chrono::steady_clock::time_point, uint64_t>;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> m_timers;
+};
+
+} // namespace
+
+int main( int argc, char** argv ) {
+    Options options;
+    if ( !parseOptions( argc, argv, options ) ) {
+        std::cerr << "usage: " << argv[0] << " --lss-socket=path --topic=id [--count=10] [--latency=fixed:MS|uniform:MIN:MAX|exp:MEAN]"
+                  << " [--error-rate=0] [--refusal-rate=0] [--payload=BYTES] [--sequence-field=sequence] [--resubscribe-delay-ms=250] [--duration-s=0] [--seed=1] [--output=file]" << std::endl;
+        return 2;
+    }
+    std::signal( SIGINT, onSignal );
+    std::signal( SIGTERM, onSignal );
+
+    char directoryTemplate[] = "/tmp/lss-farm-XXXXXX";
+    if ( mkdtemp( directoryTemplate ) == nullptr ) {
+        std::cerr << "cannot create socket directory: " << std::strerror( errno ) << std::endl;
+        return 1;
+    }
+    std::string directory = directoryTemplate;
+
+    rapidjson::Document report;
+    {
+        Farm farm( options, directory );
+        if ( !farm.start() || !farm.registerAll( "/subscribe" ) ) {
+            return 1;
+        }
+        farm.run();
+        // the service forgets subscribers that failed a delivery, so unsubscribing the rest may partly fail
+        farm.registerAll( "/unsubscribe" );
+        farm.report( report );
+    }
+    rmdir( directory.c_str() );
+
+    rapidjson::StringBuffer sb;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer( sb );
+    report.Accept( writer );
+    if ( options.output.empty() ) {
+        std::cout << sb.GetString() << std::endl;
+        return 0;
+    }
+    FILE* file = fopen( options.output.c_str(), "w" );
+    if ( file == nullptr ) {
+        std::cerr << "cannot write " << options.output << std::endl;
+        return 1;
+    }
+    fputs( sb.GetString(), file );
+    fclose( file );
+    return 0;
+}
@@ -0,0 +1,217 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOCAL_SKILL_SERVICE_RECYCLING_POOL_H
+#define AACE_ENGINE_LOCAL_SKILL_SERVICE_RECYCLING_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+/**
+ * Keeps released objects for reuse by the thread that created them, without taking a lock. A release on
+ * that thread goes straight into its cache; a release on any other thread is pushed onto the owner's
+ * lock-free return list, which the owner takes over in one exchange once its cache runs dry.
+ * Objects are constructed once and never reset by the pool.
+ */
+template <typename T, size_t CacheSize>
+class RecyclingPool {
+public:
+    /**
+     * Returns an object released earlier on this thread, or a newly constructed one.
+     */
+    static T* acquire() {
+        auto& cache = getCache();
+        if ( cache.entries.empty() ) {
+            // take back everything other threads returned since the last time
+            for ( auto header = cache.owner->returned.exchange( nullptr ); header != nullptr; ) {
+                auto next = header->next;
+                keep( cache, header );
+                header = next;
+            }
+        }
+        if ( !cache.entries.empty() ) {
+            auto header = cache.entries.back();
+            cache.entries.pop_back();
+            return getObject( header );
+        }
+        return create( cache.owner );
+    }
+
+    /**
+     * Hands the object back to the thread that created it. Objects beyond that thread's cache size are destroyed.
+     */
+    static void release( T* object ) {
+        auto header = getHeader( object );
+        auto& cache = getCache();
+        if ( header->owner == cache.owner ) {
+            keep( cache, header );
+            return;
+        }
+        // held here, since the entry may be destroyed below once it is pushed
+        auto owner = header->owner;
+        auto head = owner->returned.load();
+        do {
+            header->next = head;
+        } while ( !owner->returned.compare_exchange_weak( head, header ) );
+        if ( owner->closed.load() ) {
+            // the owning thread has exited, so nobody else will take these back
+            destroyAll( owner->returned.exchange( nullptr ) );
+        }
+    }
+
+private:
+    static_assert( alignof( T ) <= alignof( std::max_align_t ), "pooled type alignment not supported" );
+
+    struct Header;
+
+    struct Owner {
+        std::atomic<Header*> returned{ nullptr };
+        // set once the owning thread exited
+        std::atomic<bool> closed{ false };
+    };
+
+    struct Header {
+        Header* next;
+        std::shared_ptr<Owner> owner;
+    };
+
+    struct Cache {
+        Cache() : owner( std::make_shared<Owner>() ) {
+            entries.reserve( CacheSize );
+        }
+
+        ~Cache() {
+            owner->closed = true;
+            destroyAll( owner->returned.exchange( nullptr ) );
+            for ( auto header : entries ) {
+                destroy( header );
+            }
+        }
+
+        std::vector<Header*> entries;
+        std::shared_ptr<Owner> owner;
+    };
+
+    // the object follows its header in the same allocation
+    static const size_t HEADER_SIZE = ( sizeof( Header ) + alignof( std::max_align_t ) - 1 ) / alignof( std::max_align_t ) * alignof( std::max_align_t );
+
+    static Cache& getCache() {
+        static thread_local Cache cache;
+        return cache;
+    }
+
+    static T* getObject( Header* header ) {
+        return reinterpret_cast<T*>( reinterpret_cast<char*>( header ) + HEADER_SIZE );
+    }
+
+    static Header* getHeader( T* object ) {
+        return reinterpret_cast<Header*>( reinterpret_cast<char*>( object ) - HEADER_SIZE );
+    }
+
+    static T* create( const std::shared_ptr<Owner>& owner ) {
+        void* memory = ::operator new( HEADER_SIZE + sizeof( T ) );
+        auto header = new ( memory ) Header{ nullptr, owner };
+        try {
+            return new ( getObject( header ) ) T();
+        }
+        catch ( ... ) {
+            header->~Header();
+            ::operator delete( memory );
+            throw;
+        }
+    }
+
+    static void keep( Cache& cache, Header* header ) {
+        if ( cache.entries.size() < CacheSize ) {
+            cache.entries.push_back( header );
+        }
+        else {
+            destroy( header );
+        }
+    }
+
+    static void destroy( Header* header ) {
+        getObject( header )->~T();
+        header->~Header();
+        ::operator delete( header );
+    }
+
+    static void destroyAll( Header* header ) {
+        while ( header != nullptr ) {
+            auto next = header->next;
+            destroy( header );
+            header = next;
+        }
+    }
+};
+
+/**
+ * Allocator handing out fixed-size blocks from a RecyclingPool, for shared_ptr control blocks and
+ * allocate_shared. Requests larger than a block go to the heap.
+ */
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    static const size_t BLOCK_SIZE = 256;
+    using Block = typename std::aligned_storage<BLOCK_SIZE>::type;
+    using Pool = RecyclingPool<Block, 64>;
+
+    PoolAllocator() = default;
+    template <typename U>
+    PoolAllocator( const PoolAllocator<U>& ) {}
+
+    T* allocate( size_t count ) {
+        if ( fits( count ) ) {
+            return reinterpret_cast<T*>( Pool::acquire() );
+        }
+        return static_cast<T*>( ::operator new( count * sizeof( T ) ) );
+    }
+
+    void deallocate( T* block, size_t count ) {
+        if ( fits( count ) ) {
+            Pool::release( reinterpret_cast<Block*>( block ) );
+        }
+        else {
+            ::operator delete( block );
+        }
+    }
+
+private:
+    static bool fits( size_t count ) {
+        return count * sizeof( T ) <= BLOCK_SIZE && alignof( T ) <= alignof( Block );
+    }
+};
+
+template <typename T, typename U>
+bool operator==( const PoolAllocator<T>&, const PoolAllocator<U>& ) { return true; }
+
+template <typename T, typename U>
+bool operator!=( const PoolAllocator<T>&, const PoolAllocator<U>& ) { return false; }
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
+
+#endif // AACE_ENGINE_LOCAL_SKILL_SERVICE_RECYCLING_POOL_H
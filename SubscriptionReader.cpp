@@ -0,0 +1,167 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <rapidjson/error/en.h>
+
+#include "AACE/Engine/LocalSkillService/SubscriptionReader.h"
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+const unsigned SubscriptionReader::FIELD_ID;
+const unsigned SubscriptionReader::FIELD_ENDPOINT;
+const unsigned SubscriptionReader::FIELD_PATH;
+const unsigned SubscriptionReader::ALL_FIELDS;
+
+SubscriptionReader::SubscriptionReader( EntryHandler handler ) :
+    m_handler( handler ),
+    m_depth( 0 ),
+    m_entryIsObject( false ),
+    m_entryValid( false ),
+    m_fields( 0 ),
+    m_loaded( 0 ),
+    m_skipped( 0 ) {
+}
+
+bool SubscriptionReader::read( const std::string& json ) {
+    rapidjson::Reader reader;
+    rapidjson::StringStream stream( json.c_str() );
+    auto result = reader.Parse( stream, *this );
+    if ( !result && m_error.empty() ) {
+        m_error = rapidjson::GetParseError_En( result.Code() );
+    }
+    return !result.IsError();
+}
+
+unsigned SubscriptionReader::getField() const {
+    if ( m_key == "id" ) return FIELD_ID;
+    if ( m_key == "endpoint" ) return FIELD_ENDPOINT;
+    if ( m_key == "path" ) return FIELD_PATH;
+    return 0;
+}
+
+bool SubscriptionReader::beginValue() {
+    if ( m_depth == 0 ) {
+        m_error = "subscriptionsNotAnArray";
+        return false;
+    }
+    if ( m_depth == 1 ) {
+        // a scalar where an entry was expected
+        m_skipped++;
+    }
+    else if ( m_depth == 2 && m_entryIsObject && getField() != 0 ) {
+        // id, endpoint and path must be strings
+        m_entryValid = false;
+    }
+    return true;
+}
+
+bool SubscriptionReader::beginContainer() {
+    if ( m_depth == 1 ) {
+        m_entryValid = true;
+        m_fields = 0;
+        m_key.clear();
+    }
+    else if ( m_depth == 2 && m_entryIsObject && getField() != 0 ) {
+        m_entryValid = false;
+    }
+    m_depth++;
+    return true;
+}
+
+bool SubscriptionReader::endContainer() {
+    m_depth--;
+    if ( m_depth != 1 ) {
+        return true;
+    }
+    if ( m_entryIsObject && m_entryValid && m_fields == ALL_FIELDS ) {
+        m_loaded++;
+        m_handler( m_id, m_endpoint, m_path );
+    }
+    else {
+        m_skipped++;
+    }
+    return true;
+}
+
+bool SubscriptionReader::Default() {
+    return beginValue();
+}
+
+bool SubscriptionReader::String( const char* value, rapidjson::SizeType length, bool ) {
+    if ( m_depth != 2 || !m_entryIsObject ) {
+        return beginValue();
+    }
+    switch ( getField() ) {
+        case FIELD_ID:
+            m_id.assign( value, length );
+            break;
+        case FIELD_ENDPOINT:
+            m_endpoint.assign( value, length );
+            break;
+        case FIELD_PATH:
+            m_path.assign( value, length );
+            break;
+        default:
+            return true;
+    }
+    m_fields |= getField();
+    return true;
+}
+
+bool SubscriptionReader::Key( const char* value, rapidjson::SizeType length, bool ) {
+    if ( m_depth == 2 ) {
+        m_key.assign( value, length );
+    }
+    return true;
+}
+
+bool SubscriptionReader::StartObject() {
+    if ( m_depth == 0 ) {
+        return beginValue();
+    }
+    if ( m_depth == 1 ) {
+        m_entryIsObject = true;
+    }
+    return beginContainer();
+}
+
+bool SubscriptionReader::EndObject( rapidjson::SizeType ) {
+    return endContainer();
+}
+
+bool SubscriptionReader::StartArray() {
+    if ( m_depth == 0 ) {
+        m_depth++;
+        return true;
+    }
+    if ( m_depth == 1 ) {
+        m_entryIsObject = false;
+    }
+    return beginContainer();
+}
+
+bool SubscriptionReader::EndArray( rapidjson::SizeType ) {
+    if ( m_depth == 1 ) {
+        m_depth--;
+        return true;
+    }
+    return endContainer();
+}
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
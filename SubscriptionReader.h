@@ -0,0 +1,90 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOCAL_SKILL_SERVICE_SUBSCRIPTION_READER_H
+#define AACE_ENGINE_LOCAL_SKILL_SERVICE_SUBSCRIPTION_READER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include <rapidjson/reader.h>
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+/**
+ * Streams the persisted subscriptions, an array of { "id", "endpoint", "path" } objects, into a callback
+ * with rapidjson's SAX reader instead of building a DOM. Malformed entries are counted and skipped; a
+ * syntax error stops the read, but the entries before it have already been delivered.
+ */
+class SubscriptionReader : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, SubscriptionReader> {
+public:
+    using EntryHandler = std::function<void(const std::string& id, const std::string& endpoint, const std::string& path)>;
+
+    explicit SubscriptionReader( EntryHandler handler );
+
+    /**
+     * Reads @c json and returns true if the whole document was read, otherwise see getError().
+     */
+    bool read( const std::string& json );
+
+    size_t getLoadedCount() const { return m_loaded; }
+    size_t getSkippedCount() const { return m_skipped; }
+    const std::string& getError() const { return m_error; }
+
+    // rapidjson SAX events
+    bool Default();
+    bool String( const char* value, rapidjson::SizeType length, bool copy );
+    bool Key( const char* value, rapidjson::SizeType length, bool copy );
+    bool StartObject();
+    bool EndObject( rapidjson::SizeType count );
+    bool StartArray();
+    bool EndArray( rapidjson::SizeType count );
+
+private:
+    // fields of the current entry, set once seen as strings
+    static const unsigned FIELD_ID = 1;
+    static const unsigned FIELD_ENDPOINT = 2;
+    static const unsigned FIELD_PATH = 4;
+    static const unsigned ALL_FIELDS = FIELD_ID | FIELD_ENDPOINT | FIELD_PATH;
+
+    bool beginValue();
+    bool beginContainer();
+    bool endContainer();
+    // returns the field the current key names, or 0
+    unsigned getField() const;
+
+    EntryHandler m_handler;
+    // container nesting; 1 is the top level array and 2 the inside of an entry
+    unsigned m_depth;
+    bool m_entryIsObject;
+    bool m_entryValid;
+    unsigned m_fields;
+    std::string m_key;
+    std::string m_id;
+    std::string m_endpoint;
+    std::string m_path;
+    size_t m_loaded;
+    size_t m_skipped;
+    std::string m_error;
+};
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
+
+#endif // AACE_ENGINE_LOCAL_SKILL_SERVICE_SUBSCRIPTION_READER_H
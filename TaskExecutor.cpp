@@ -0,0 +1,108 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "AACE/Engine/LocalSkillService/TaskExecutor.h"
+#include "AACE/Engine/Core/EngineMacros.h"
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+// String to identify log entries originating from this file.
+static const std::string TAG("aace.localSkillService.TaskExecutor");
+
+// empty polls a worker makes before going to sleep
+static const int SPIN_COUNT = 64;
+
+const size_t TaskExecutor::TASK_CAPACITY;
+
+TaskExecutor::TaskExecutor( size_t threadCount, size_t queueCapacity ) : m_queue( queueCapacity ), m_shutdown( false ), m_sleepers( 0 ) {
+    for ( size_t i = 0; i < threadCount; i++ ) {
+        m_threads.emplace_back( &TaskExecutor::run, this );
+    }
+}
+
+TaskExecutor::~TaskExecutor() {
+    shutdown();
+}
+
+bool TaskExecutor::submit( Task task ) {
+    if ( m_shutdown.load() || !m_queue.push( task ) ) {
+        return false;
+    }
+    // pairs with the fence in run() so a worker going to sleep either sees the task or is counted here
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if ( m_sleepers.load() > 0 ) {
+        std::lock_guard<std::mutex> guard( m_mutex );
+        m_cv.notify_one();
+    }
+    return true;
+}
+
+size_t TaskExecutor::getQueueDepth() const {
+    return m_queue.size();
+}
+
+void TaskExecutor::shutdown() {
+    {
+        std::lock_guard<std::mutex> guard( m_mutex );
+        if ( m_shutdown.exchange( true ) ) {
+            return;
+        }
+    }
+    m_cv.notify_all();
+    for ( auto& thread : m_threads ) {
+        if ( thread.joinable() && thread.get_id() != std::this_thread::get_id() ) {
+            thread.join();
+        }
+        else if ( thread.joinable() ) {
+            thread.detach();
+        }
+    }
+}
+
+void TaskExecutor::run() {
+    Task task;
+    int spins = 0;
+    while ( !m_shutdown.load() ) {
+        if ( m_queue.pop( task ) ) {
+            spins = 0;
+            try {
+                task();
+            }
+            catch( std::exception& ex ) {
+                AACE_ERROR(LX(TAG).d("reason", ex.what()));
+            }
+            task.reset();
+            continue;
+        }
+        if ( ++spins < SPIN_COUNT ) {
+            std::this_thread::yield();
+            continue;
+        }
+        spins = 0;
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_sleepers++;
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        if ( m_queue.size() == 0 && !m_shutdown.load() ) {
+            m_cv.wait( lock );
+        }
+        m_sleepers--;
+    }
+}
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
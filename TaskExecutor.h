@@ -0,0 +1,75 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOCAL_SKILL_SERVICE_TASK_EXECUTOR_H
+#define AACE_ENGINE_LOCAL_SKILL_SERVICE_TASK_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "AACE/Engine/LocalSkillService/BoundedQueue.h"
+#include "AACE/Engine/LocalSkillService/InplaceTask.h"
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+/**
+ * Fixed pool of worker threads fed by a bounded lock-free queue of inline tasks.
+ * Submitting and running a task does not allocate; idle workers sleep until work arrives.
+ */
+class TaskExecutor {
+public:
+    // large enough for a request handler invocation: a std::function and a few shared_ptrs
+    static const size_t TASK_CAPACITY = 128;
+    using Task = InplaceTask<TASK_CAPACITY>;
+
+    TaskExecutor( size_t threadCount, size_t queueCapacity );
+    ~TaskExecutor();
+
+    /**
+     * Queues a task. Returns false if the queue is full or the executor has been shut down.
+     */
+    bool submit( Task task );
+
+    size_t getQueueDepth() const;
+
+    /**
+     * Stops the workers once their current task completes. Queued tasks are discarded.
+     */
+    void shutdown();
+
+private:
+    TaskExecutor( const TaskExecutor& ) = delete;
+    TaskExecutor& operator=( const TaskExecutor& ) = delete;
+
+    void run();
+
+    BoundedQueue<Task> m_queue;
+    std::atomic<bool> m_shutdown;
+    std::atomic<size_t> m_sleepers;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<std::thread> m_threads;
+};
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
+
+#endif // AACE_ENGINE_LOCAL_SKILL_SERVICE_TASK_EXECUTOR_H
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "AACE/Engine/LocalSkillService/TimerQueue.h"
+#include "AACE/Engine/Core/EngineMacros.h"
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+// String to identify log entries originating from this file.
+static const std::string TAG("aace.localSkillService.TimerQueue");
+
+TimerQueue::TimerQueue() : m_nextId( 1 ), m_shutdown( false ) {
+    m_thread = std::thread( &TimerQueue::run, this );
+}
+
+TimerQueue::~TimerQueue() {
+    shutdown();
+}
+
+TimerQueue::TimerId TimerQueue::schedule( std::chrono::steady_clock::time_point when, Task task ) {
+    std::lock_guard<std::mutex> guard( m_mutex );
+    if ( m_shutdown ) {
+        return 0;
+    }
+    TimerId id = m_nextId++;
+    bool earliest = m_timers.empty() || when < m_timers.begin()->first.first;
+    m_timers.emplace( Key( when, id ), std::move( task ) );
+    m_deadlines.emplace( id, when );
+    if ( earliest ) {
+        m_cv.notify_one();
+    }
+    return id;
+}
+
+TimerQueue::TimerId TimerQueue::schedule( std::chrono::milliseconds delay, Task task ) {
+    return schedule( std::chrono::steady_clock::now() + delay, std::move( task ) );
+}
+
+bool TimerQueue::cancel( TimerId id ) {
+    std::lock_guard<std::mutex> guard( m_mutex );
+    auto it = m_deadlines.find( id );
+    if ( it == m_deadlines.end() ) {
+        return false;
+    }
+    m_timers.erase( Key( it->second, id ) );
+    m_deadlines.erase( it );
+    return true;
+}
+
+void TimerQueue::shutdown() {
+    {
+        std::lock_guard<std::mutex> guard( m_mutex );
+        if ( m_shutdown ) {
+            return;
+        }
+        m_shutdown = true;
+        m_timers.clear();
+        m_deadlines.clear();
+    }
+    m_cv.notify_one();
+    if ( m_thread.joinable() ) {
+        m_thread.join();
+    }
+}
+
+void TimerQueue::run() {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    while ( !m_shutdown ) {
+        if ( m_timers.empty() ) {
+            m_cv.wait( lock );
+            continue;
+        }
+        auto next = m_timers.begin();
+        if ( std::chrono::steady_clock::now() < next->first.first ) {
+            m_cv.wait_until( lock, next->first.first );
+            continue;
+        }
+        Task task = std::move( next->second );
+        m_deadlines.erase( next->first.second );
+        m_timers.erase( next );
+        lock.unlock();
+        try {
+            task();
+        }
+        catch( std::exception& ex ) {
+            AACE_ERROR(LX(TAG).d("reason", ex.what()));
+        }
+        lock.lock();
+    }
+}
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
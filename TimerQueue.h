@@ -0,0 +1,73 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOCAL_SKILL_SERVICE_TIMER_QUEUE_H
+#define AACE_ENGINE_LOCAL_SKILL_SERVICE_TIMER_QUEUE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+/**
+ * Runs callbacks at absolute points in time from a single background thread.
+ * Callbacks should be short; anything expensive belongs on an executor.
+ */
+class TimerQueue {
+public:
+    using Task = std::function<void()>;
+    using TimerId = uint64_t;
+
+    TimerQueue();
+    ~TimerQueue();
+
+    TimerId schedule( std::chrono::steady_clock::time_point when, Task task );
+    TimerId schedule( std::chrono::milliseconds delay, Task task );
+
+    /**
+     * Cancels a pending timer. Returns false if it already ran or was never scheduled.
+     */
+    bool cancel( TimerId id );
+
+    void shutdown();
+
+private:
+    void run();
+
+    using Key = std::pair<std::chrono::steady_clock::time_point, TimerId>;
+
+    std::map<Key, Task> m_timers;
+    std::unordered_map<TimerId, std::chrono::steady_clock::time_point> m_deadlines;
+    TimerId m_nextId;
+    bool m_shutdown;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+};
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
+
+#endif // AACE_ENGINE_LOCAL_SKILL_SERVICE_TIMER_QUEUE_H
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "AACE/Engine/LocalSkillService/ToolSupport.h"
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+namespace tools {
+
+bool MemoryStorage::put( const std::string& table, const std::string& key, const std::string& value ) {
+    std::lock_guard<std::mutex> guard( m_mutex );
+    m_values[ table + "/" + key ] = value;
+    return true;
+}
+
+std::string MemoryStorage::get( const std::string& table, const std::string& key, const std::string& defaultValue ) {
+    std::lock_guard<std::mutex> guard( m_mutex );
+    auto it = m_values.find( table + "/" + key );
+    return it != m_values.end() ? it->second : defaultValue;
+}
+
+bool MemoryStorage::removeKey( const std::string& table, const std::string& key ) {
+    std::lock_guard<std::mutex> guard( m_mutex );
+    return m_values.erase( table + "/" + key ) > 0;
+}
+
+bool MemoryStorage::removeAll( const std::string& table ) {
+    std::lock_guard<std::mutex> guard( m_mutex );
+    auto prefix = table + "/";
+    for ( auto it = m_values.begin(); it != m_values.end(); ) {
+        it = it->first.compare( 0, prefix.size(), prefix ) == 0 ? m_values.erase( it ) : std::next( it );
+    }
+    return true;
+}
+
+bool MemoryStorage::containsKey( const std::string& table, const std::string& key ) {
+    std::lock_guard<std::mutex> guard( m_mutex );
+    return m_values.count( table + "/" + key ) > 0;
+}
+
+HttpClient::HttpClient() : m_fd( -1 ) {
+}
+
+HttpClient::~HttpClient() {
+    if ( m_fd >= 0 ) {
+        close( m_fd );
+    }
+}
+
+bool HttpClient::connect( const std::string& socketPath ) {
+    if ( m_fd >= 0 ) {
+        close( m_fd );
+    }
+    m_input.clear();
+    m_fd = socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+    if ( m_fd < 0 ) {
+        return false;
+    }
+    sockaddr_un address;
+    std::memset( &address, 0, sizeof( address ) );
+    address.sun_family = AF_UNIX;
+    std::strncpy( address.sun_path, socketPath.c_str(), sizeof( address.sun_path ) - 1 );
+    return ::connect( m_fd, reinterpret_cast<sockaddr*>( &address ), sizeof( address ) ) == 0;
+}
+
+int HttpClient::request( const std::string& method, const std::string& path, const std::string& body ) {
+    std::string request = method + " " + path + " HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string( body.size() ) + "\r\n\r\n" + body;
+    size_t sent = 0;
+    while ( sent < request.size() ) {
+        auto count = send( m_fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL );
+        if ( count <= 0 ) {
+            return 0;
+        }
+        sent += count;
+    }
+    size_t headerEnd;
+    while ( ( headerEnd = m_input.find( "\r\n\r\n" ) ) == std::string::npos ) {
+        if ( !receive() ) {
+            return 0;
+        }
+    }
+    int status = std::atoi( m_input.c_str() + m_input.find( ' ' ) + 1 );
+    size_t length = 0;
+    auto header = m_input.find( "Content-Length:" );
+    if ( header == std::string::npos ) {
+        header = m_input.find( "content-length:" );
+    }
+    if ( header != std::string::npos && header < headerEnd ) {
+        length = std::strtoull( m_input.c_str() + header + 15, nullptr, 10 );
+    }
+    while ( m_input.size() < headerEnd + 4 + length ) {
+        if ( !receive() ) {
+            return 0;
+        }
+    }
+    m_input.erase( 0, headerEnd + 4 + length );
+    return status;
+}
+
+bool HttpClient::receive() {
+    char buffer[16384];
+    auto count = recv( m_fd, buffer, sizeof( buffer ), 0 );
+    if ( count <= 0 ) {
+        return false;
+    }
+    m_input.append( buffer, count );
+    return true;
+}
+
+StubSubscribers::StubSubscribers( const std::string& directory, std::chrono::milliseconds slowDelay ) : m_directory( directory ), m_slowDelay( slowDelay ), m_next( 0 ) {
+}
+
+StubSubscribers::~StubSubscribers() {
+    for ( auto& server : m_servers ) {
+        server->stop();
+    }
+    m_timers.shutdown();
+}
+
+std::string StubSubscribers::add( Kind kind ) {
+    auto path = m_directory + "/subscriber-" + std::to_string( m_next++ ) + ".sock";
+    if ( kind == Kind::DEAD ) {
+        // nothing listens on the socket, so every delivery fails to connect
+        return path;
+    }
+    auto server = HttpServer::create( path );
+    auto& timers = m_timers;
+    auto delay = m_slowDelay;
+    if ( kind == Kind::SLOW ) {
+        server->setRequestHandler( [&timers, delay]( std::shared_ptr<HttpRequest> request ) {
+            timers.schedule( delay, [request] {
+                request->respond( 200, "{}" );
+            } );
+        } );
+    }
+    else {
+        server->setRequestHandler( []( std::shared_ptr<HttpRequest> request ) {
+            request->respond( 200, "{}" );
+        } );
+    }
+    if ( server->start() ) {
+        m_servers.push_back( server );
+    }
+    return path;
+}
+
+} // aace::engine::localSkillService::tools
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOCAL_SKILL_SERVICE_TOOL_SUPPORT_H
+#define AACE_ENGINE_LOCAL_SKILL_SERVICE_TOOL_SUPPORT_H
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "AACE/Engine/LocalSkillService/HttpServer.h"
+#include "AACE/Engine/LocalSkillService/TimerQueue.h"
+#include "AACE/Engine/Storage/LocalStorageInterface.h"
+
+// Building blocks shared by the benchmark and replay tools; not part of the service.
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+namespace tools {
+
+/**
+ * In-memory stand-in for the engine storage service.
+ */
+class MemoryStorage : public aace::engine::storage::LocalStorageInterface {
+public:
+    bool put( const std::string& table, const std::string& key, const std::string& value ) override;
+    std::string get( const std::string& table, const std::string& key, const std::string& defaultValue ) override;
+    bool removeKey( const std::string& table, const std::string& key );
+    bool removeAll( const std::string& table );
+    bool containsKey( const std::string& table, const std::string& key );
+
+private:
+    std::map<std::string, std::string> m_values;
+    std::mutex m_mutex;
+};
+
+/**
+ * Blocking HTTP/1.1 client on a persistent UNIX socket connection.
+ */
+class HttpClient {
+public:
+    HttpClient();
+    ~HttpClient();
+
+    bool connect( const std::string& socketPath );
+
+    /**
+     * Sends a request and waits for its response. Returns the response status, or 0 if the connection failed.
+     */
+    int request( const std::string& method, const std::string& path, const std::string& body );
+
+private:
+    HttpClient( const HttpClient& ) = delete;
+    HttpClient& operator=( const HttpClient& ) = delete;
+
+    bool receive();
+
+    int m_fd;
+    std::string m_input;
+};
+
+/**
+ * Stub subscribers, one HttpServer each, that answer every delivery immediately, after a delay, or not at all.
+ */
+class StubSubscribers {
+public:
+    enum class Kind { HEALTHY, SLOW, DEAD };
+
+    StubSubscribers( const std::string& directory, std::chrono::milliseconds slowDelay );
+    ~StubSubscribers();
+
+    /**
+     * Starts a subscriber and returns its socket path. Nothing listens on the path of a dead subscriber.
+     */
+    std::string add( Kind kind );
+
+private:
+    std::string m_directory;
+    std::chrono::milliseconds m_slowDelay;
+    size_t m_next;
+    TimerQueue m_timers;
+    std::vector<std::shared_ptr<HttpServer>> m_servers;
+};
+
+} // aace::engine::localSkillService::tools
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
+
+#endif // AACE_ENGINE_LOCAL_SKILL_SERVICE_TOOL_SUPPORT_H
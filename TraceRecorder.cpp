@@ -0,0 +1,197 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <unistd.h>
+
+#include "AACE/Engine/Core/EngineMacros.h"
+#include "AACE/Engine/LocalSkillService/TraceRecorder.h"
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+// String to identify log entries originating from this file.
+static const std::string TAG("aace.localSkillService.TraceRecorder");
+
+// number of buffered spans that triggers a write
+static const size_t WRITE_THRESHOLD = 512;
+
+static uint32_t getThreadNumber() {
+    static std::atomic<uint32_t> next( 1 );
+    static thread_local uint32_t number = next++;
+    return number;
+}
+
+static int64_t toMicroseconds( std::chrono::steady_clock::time_point time ) {
+    return std::chrono::duration_cast<std::chrono::microseconds>( time.time_since_epoch() ).count();
+}
+
+static void appendEscaped( std::string& out, const std::string& value ) {
+    for ( auto c : value ) {
+        if ( c == '"' || c == '\\' ) {
+            out += '\\';
+            out += c;
+        }
+        else if ( static_cast<unsigned char>( c ) < 0x20 ) {
+            char escaped[8];
+            snprintf( escaped, sizeof( escaped ), "\\u%04x", static_cast<unsigned>( c ) );
+            out += escaped;
+        }
+        else {
+            out += c;
+        }
+    }
+}
+
+TraceRecorder& TraceRecorder::getInstance() {
+    static TraceRecorder instance;
+    return instance;
+}
+
+TraceRecorder::TraceRecorder() : m_open( false ), m_sampleRate( 1 ), m_sequence( 0 ), m_file( nullptr ), m_firstEvent( true ), m_processId( getpid() ) {
+}
+
+TraceRecorder::~TraceRecorder() {
+    close();
+}
+
+bool TraceRecorder::open( const std::string& path, uint32_t sampleRate ) {
+    try {
+        ThrowIf( sampleRate == 0, "invalidSampleRate" );
+        close();
+        std::lock_guard<std::mutex> guard( m_fileMutex );
+        m_file = fopen( path.c_str(), "w" );
+        ThrowIfNull( m_file, "openTraceFileFailed" );
+        // the array format also loads when the closing bracket is missing, so a crash keeps what was written
+        fputs( "[\n", m_file );
+        m_firstEvent = true;
+        {
+            // spans that raced with an earlier close() belong to the old file
+            std::lock_guard<std::mutex> eventGuard( m_mutex );
+            m_events.clear();
+        }
+        m_sampleRate = sampleRate;
+        m_open = true;
+        return true;
+    }
+    catch( std::exception& ex ) {
+        AACE_ERROR(LX(TAG).d("path", path).d("reason", ex.what()));
+        return false;
+    }
+}
+
+void TraceRecorder::close() {
+    if ( !m_open.exchange( false ) ) {
+        return;
+    }
+    std::vector<Event> events;
+    {
+        std::lock_guard<std::mutex> guard( m_mutex );
+        events.swap( m_events );
+    }
+    writeEvents( events );
+    std::lock_guard<std::mutex> guard( m_fileMutex );
+    if ( m_file != nullptr ) {
+        fputs( "\n]\n", m_file );
+        fclose( m_file );
+        m_file = nullptr;
+    }
+}
+
+uint64_t TraceRecorder::sample() {
+    // acquire pairs with the store in open(), so the sample rate set before it is visible
+    if ( !m_open.load( std::memory_order_acquire ) ) {
+        return 0;
+    }
+    auto sequence = m_sequence.fetch_add( 1, std::memory_order_relaxed ) + 1;
+    return sequence % m_sampleRate.load( std::memory_order_relaxed ) == 0 ? sequence : 0;
+}
+
+void TraceRecorder::record( uint64_t traceId, const char* name, const char* category, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, const std::string& detail ) {
+    if ( traceId == 0 || !m_open.load( std::memory_order_relaxed ) ) {
+        return;
+    }
+    Event event{ name, category, traceId, toMicroseconds( start ), toMicroseconds( end ) - toMicroseconds( start ), getThreadNumber(), detail };
+    std::vector<Event> events;
+    {
+        std::lock_guard<std::mutex> guard( m_mutex );
+        m_events.push_back( std::move( event ) );
+        if ( m_events.size() < WRITE_THRESHOLD ) {
+            return;
+        }
+        events.swap( m_events );
+    }
+    writeEvents( events );
+}
+
+void TraceRecorder::writeEvents( const std::vector<Event>& events ) {
+    if ( events.empty() ) {
+        return;
+    }
+    std::string out;
+    out.reserve( events.size() * 160 );
+    std::lock_guard<std::mutex> guard( m_fileMutex );
+    if ( m_file == nullptr ) {
+        return;
+    }
+    for ( auto& event : events ) {
+        if ( !m_firstEvent ) {
+            out += ",\n";
+        }
+        m_firstEvent = false;
+        out += "{\"name\":\"";
+        out += event.name;
+        out += "\",\"cat\":\"";
+        out += event.category;
+        out += "\",\"ph\":\"X\",\"ts\":";
+        out += std::to_string( event.start );
+        out += ",\"dur\":";
+        out += std::to_string( event.duration );
+        out += ",\"pid\":";
+        out += std::to_string( m_processId );
+        out += ",\"tid\":";
+        out += std::to_string( event.thread );
+        out += ",\"args\":{\"trace\":";
+        out += std::to_string( event.traceId );
+        if ( !event.detail.empty() ) {
+            out += ",\"detail\":\"";
+            appendEscaped( out, event.detail );
+            out += '"';
+        }
+        out += "}}";
+    }
+    fwrite( out.data(), 1, out.size(), m_file );
+    fflush( m_file );
+}
+
+TraceSpan::TraceSpan( uint64_t traceId, const char* name, const char* category, const std::string& detail ) :
+    m_traceId( traceId ),
+    m_name( name ),
+    m_category( category ) {
+    if ( m_traceId != 0 ) {
+        m_detail = detail;
+        m_start = std::chrono::steady_clock::now();
+    }
+}
+
+TraceSpan::~TraceSpan() {
+    if ( m_traceId != 0 ) {
+        TraceRecorder::getInstance().record( m_traceId, m_name, m_category, m_start, std::chrono::steady_clock::now(), m_detail );
+    }
+}
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
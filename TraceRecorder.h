@@ -0,0 +1,140 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOCAL_SKILL_SERVICE_TRACE_RECORDER_H
+#define AACE_ENGINE_LOCAL_SKILL_SERVICE_TRACE_RECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+/**
+ * Records timed spans of sampled requests and deliveries to a file in the Chrome Trace Event format,
+ * which chrome://tracing and the Perfetto UI open directly. Spans of one request or publish share a
+ * trace id, so a whole timeline can be picked out of the file.
+ *
+ * Instrumentation goes through the LSS_TRACE macros, which compile to nothing unless LSS_TRACING is
+ * defined. With tracing compiled in, an unsampled request costs one atomic increment.
+ */
+class TraceRecorder {
+public:
+    static TraceRecorder& getInstance();
+
+    /**
+     * Starts writing spans to @c path, tracing one of every @c sampleRate requests and publishes.
+     */
+    bool open( const std::string& path, uint32_t sampleRate );
+
+    /**
+     * Writes the remaining spans and closes the trace file.
+     */
+    void close();
+
+    /**
+     * Returns the id to trace the next request or publish under, or 0 if it is not sampled.
+     */
+    uint64_t sample();
+
+    /**
+     * Records a span. @c name and @c category must be string literals; @c detail is copied.
+     */
+    void record( uint64_t traceId, const char* name, const char* category, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, const std::string& detail = "" );
+
+    ~TraceRecorder();
+
+private:
+    TraceRecorder();
+    TraceRecorder( const TraceRecorder& ) = delete;
+    TraceRecorder& operator=( const TraceRecorder& ) = delete;
+
+    struct Event {
+        const char* name;
+        const char* category;
+        uint64_t traceId;
+        int64_t start;
+        int64_t duration;
+        uint32_t thread;
+        std::string detail;
+    };
+
+    void writeEvents( const std::vector<Event>& events );
+
+    std::atomic<bool> m_open;
+    std::atomic<uint32_t> m_sampleRate;
+    std::atomic<uint64_t> m_sequence;
+
+    // spans waiting to be written
+    std::vector<Event> m_events;
+    std::mutex m_mutex;
+
+    FILE* m_file;
+    bool m_firstEvent;
+    int m_processId;
+    // guards the file and is taken without m_mutex held
+    std::mutex m_fileMutex;
+};
+
+/**
+ * Records a span from its construction to the end of the enclosing scope if the trace is sampled.
+ */
+class TraceSpan {
+public:
+    TraceSpan( uint64_t traceId, const char* name, const char* category, const std::string& detail = "" );
+    ~TraceSpan();
+
+private:
+    TraceSpan( const TraceSpan& ) = delete;
+    TraceSpan& operator=( const TraceSpan& ) = delete;
+
+    uint64_t m_traceId;
+    const char* m_name;
+    const char* m_category;
+    std::string m_detail;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
+
+#define LSS_TRACE_CONCAT_( a, b ) a##b
+#define LSS_TRACE_CONCAT( a, b ) LSS_TRACE_CONCAT_( a, b )
+
+#ifdef LSS_TRACING
+#define LSS_TRACE_SAMPLE() aace::engine::localSkillService::TraceRecorder::getInstance().sample()
+#define LSS_TRACE_NOW( traceId ) ( ( traceId ) != 0 ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point() )
+#define LSS_TRACE_SPAN( traceId, ... ) \
+    do { \
+        if ( ( traceId ) != 0 ) { \
+            aace::engine::localSkillService::TraceRecorder::getInstance().record( traceId, __VA_ARGS__ ); \
+        } \
+    } while( 0 )
+#define LSS_TRACE_SCOPE( ... ) aace::engine::localSkillService::TraceSpan LSS_TRACE_CONCAT( lssTraceSpan, __LINE__ )( __VA_ARGS__ )
+#else
+#define LSS_TRACE_SAMPLE() uint64_t( 0 )
+#define LSS_TRACE_NOW( traceId ) std::chrono::steady_clock::time_point()
+#define LSS_TRACE_SPAN( traceId, ... ) do {} while( 0 )
+#define LSS_TRACE_SCOPE( ... ) do {} while( 0 )
+#endif
+
+#endif // AACE_ENGINE_LOCAL_SKILL_SERVICE_TRACE_RECORDER_H
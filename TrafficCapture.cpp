@@ -0,0 +1,168 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "AACE/Engine/Core/EngineMacros.h"
+#include "AACE/Engine/LocalSkillService/TrafficCapture.h"
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+// String to identify log entries originating from this file.
+static const std::string TAG("aace.localSkillService.TrafficCapture");
+
+// identifies capture files and their format version
+static const char CAPTURE_MAGIC[8] = { 'L', 'S', 'S', 'C', 'A', 'P', '0', '1' };
+
+// type, offset, name length and body length
+static const size_t RECORD_HEADER_SIZE = 1 + 8 + 4 + 4;
+
+TrafficCapture::TrafficCapture() : m_open( false ), m_file( nullptr ) {
+}
+
+TrafficCapture::~TrafficCapture() {
+    close();
+}
+
+bool TrafficCapture::open( const std::string& path ) {
+    try {
+        std::lock_guard<std::mutex> guard( m_mutex );
+        ThrowIfNotNull( m_file, "captureAlreadyOpen" );
+        // bodies are captured in plaintext, so only the owner may read the file
+        int fd = ::open( path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600 );
+        ThrowIf( fd < 0, "openCaptureFileFailed" );
+        m_file = fdopen( fd, "wb" );
+        if ( m_file == nullptr ) {
+            ::close( fd );
+            Throw( "openCaptureFileFailed" );
+        }
+        ThrowIf( fwrite( CAPTURE_MAGIC, sizeof( CAPTURE_MAGIC ), 1, m_file ) != 1, "writeCaptureHeaderFailed" );
+        m_start = std::chrono::steady_clock::now();
+        m_open = true;
+        AACE_WARN(LX(TAG).d("path", path).m("captureStarted: request bodies and publish payloads are written unredacted"));
+        return true;
+    }
+    catch( std::exception& ex ) {
+        AACE_ERROR(LX(TAG).d("path", path).d("reason", ex.what()));
+        if ( m_file != nullptr ) {
+            fclose( m_file );
+            m_file = nullptr;
+        }
+        return false;
+    }
+}
+
+void TrafficCapture::close() {
+    std::lock_guard<std::mutex> guard( m_mutex );
+    m_open = false;
+    if ( m_file != nullptr ) {
+        fclose( m_file );
+        m_file = nullptr;
+    }
+}
+
+void TrafficCapture::recordRequest( const std::string& method, const std::string& path, const std::string& body ) {
+    write( TrafficRecord::Type::REQUEST, method + " " + path, body );
+}
+
+void TrafficCapture::recordPublish( const std::string& topic, const std::string& payload ) {
+    write( TrafficRecord::Type::PUBLISH, topic, payload );
+}
+
+void TrafficCapture::write( TrafficRecord::Type type, const std::string& name, const std::string& body ) {
+    auto offset = static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - m_start ).count() );
+    auto nameSize = static_cast<uint32_t>( name.size() );
+    auto bodySize = static_cast<uint32_t>( body.size() );
+    char header[ RECORD_HEADER_SIZE ];
+    header[0] = static_cast<char>( type );
+    std::memcpy( header + 1, &offset, sizeof( offset ) );
+    std::memcpy( header + 9, &nameSize, sizeof( nameSize ) );
+    std::memcpy( header + 13, &bodySize, sizeof( bodySize ) );
+
+    std::lock_guard<std::mutex> guard( m_mutex );
+    if ( m_file == nullptr ) {
+        return;
+    }
+    if ( fwrite( header, sizeof( header ), 1, m_file ) != 1 || fwrite( name.data(), 1, nameSize, m_file ) != nameSize || fwrite( body.data(), 1, bodySize, m_file ) != bodySize ) {
+        AACE_ERROR(LX(TAG).d("reason", "writeCaptureFailed").m("stoppingCapture"));
+        m_open = false;
+        fclose( m_file );
+        m_file = nullptr;
+    }
+}
+
+TrafficReader::TrafficReader() : m_file( nullptr ) {
+}
+
+TrafficReader::~TrafficReader() {
+    if ( m_file != nullptr ) {
+        fclose( m_file );
+    }
+}
+
+bool TrafficReader::open( const std::string& path ) {
+    try {
+        ThrowIfNotNull( m_file, "readerAlreadyOpen" );
+        m_file = fopen( path.c_str(), "rb" );
+        ThrowIfNull( m_file, "openCaptureFileFailed" );
+        char magic[ sizeof( CAPTURE_MAGIC ) ];
+        ThrowIf( fread( magic, sizeof( magic ), 1, m_file ) != 1 || std::memcmp( magic, CAPTURE_MAGIC, sizeof( magic ) ) != 0, "notACaptureFile" );
+        return true;
+    }
+    catch( std::exception& ex ) {
+        AACE_ERROR(LX(TAG).d("path", path).d("reason", ex.what()));
+        if ( m_file != nullptr ) {
+            fclose( m_file );
+            m_file = nullptr;
+        }
+        return false;
+    }
+}
+
+bool TrafficReader::next( TrafficRecord& record ) {
+    if ( m_file == nullptr ) {
+        return false;
+    }
+    char header[ RECORD_HEADER_SIZE ];
+    if ( fread( header, sizeof( header ), 1, m_file ) != 1 ) {
+        return false;
+    }
+    uint64_t offset;
+    uint32_t nameSize;
+    uint32_t bodySize;
+    std::memcpy( &offset, header + 1, sizeof( offset ) );
+    std::memcpy( &nameSize, header + 9, sizeof( nameSize ) );
+    std::memcpy( &bodySize, header + 13, sizeof( bodySize ) );
+    record.type = static_cast<TrafficRecord::Type>( header[0] );
+    record.offset = std::chrono::microseconds( offset );
+    record.name.resize( nameSize );
+    record.body.resize( bodySize );
+    if ( nameSize > 0 && fread( &record.name[0], 1, nameSize, m_file ) != nameSize ) {
+        return false;
+    }
+    if ( bodySize > 0 && fread( &record.body[0], 1, bodySize, m_file ) != bodySize ) {
+        return false;
+    }
+    return true;
+}
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOCAL_SKILL_SERVICE_TRAFFIC_CAPTURE_H
+#define AACE_ENGINE_LOCAL_SKILL_SERVICE_TRAFFIC_CAPTURE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+namespace aace {
+namespace engine {
+namespace localSkillService {
+
+/**
+ * One captured request or publish.
+ */
+struct TrafficRecord {
+    enum class Type : uint8_t { REQUEST = 1, PUBLISH = 2 };
+
+    Type type;
+    // time since the capture was opened
+    std::chrono::microseconds offset;
+    // "METHOD /path" of a request, or the topic id of a publish
+    std::string name;
+    std::string body;
+};
+
+/**
+ * Writes the requests and publishes handled by the service to a compact binary file for later replay.
+ * Each record is a type byte, the offset in microseconds and the lengths of name and body, followed by
+ * the name and body bytes. Integers are in host byte order.
+ *
+ * Bodies and payloads are written verbatim and unencrypted, unlike the logs, which only show them as sensitive
+ * data. A capture can therefore hold user data; the file is created readable by its owner only and is meant
+ * for debugging, not for production devices.
+ */
+class TrafficCapture {
+public:
+    TrafficCapture();
+    ~TrafficCapture();
+
+    bool open( const std::string& path );
+    void close();
+
+    bool isOpen() const { return m_open.load( std::memory_order_relaxed ); }
+
+    void recordRequest( const std::string& method, const std::string& path, const std::string& body );
+    void recordPublish( const std::string& topic, const std::string& payload );
+
+private:
+    TrafficCapture( const TrafficCapture& ) = delete;
+    TrafficCapture& operator=( const TrafficCapture& ) = delete;
+
+    void write( TrafficRecord::Type type, const std::string& name, const std::string& body );
+
+    std::atomic<bool> m_open;
+    std::chrono::steady_clock::time_point m_start;
+    FILE* m_file;
+    std::mutex m_mutex;
+};
+
+/**
+ * Reads a file written by TrafficCapture.
+ */
+class TrafficReader {
+public:
+    TrafficReader();
+    ~TrafficReader();
+
+    bool open( const std::string& path );
+
+    /**
+     * Reads the next record. Returns false at the end of the file or on a truncated record.
+     */
+    bool next( TrafficRecord& record );
+
+private:
+    TrafficReader( const TrafficReader& ) = delete;
+    TrafficReader& operator=( const TrafficReader& ) = delete;
+
+    FILE* m_file;
+};
+
+} // aace::engine::localSkillService
+} // aace::engine
+} // aace
+
+#endif // AACE_ENGINE_LOCAL_SKILL_SERVICE_TRAFFIC_CAPTURE_H